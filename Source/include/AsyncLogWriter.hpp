@@ -0,0 +1,142 @@
+#pragma once
+#include "MpmcRingBuffer.hpp"
+#include "spdlog/details/log_msg.h"
+#include "spdlog/details/os.h"
+#include "spdlog/sinks/sink.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// What producer does when log queue is full
+enum class LogOverflowPolicy : uint8_t { Block, DropOldest, DropNew };
+
+struct AsyncLogConfiguration {
+    size_t queueSize{8192};
+    LogOverflowPolicy overflowPolicy{LogOverflowPolicy::DropNew};
+};
+
+// Moves writing of log messages off producing threads. Messages are copied into preallocated slots of lock-free
+// ring, background thread is the only one writing them to sink. Only Block policy may make producer wait.
+class AsyncLogWriter {
+public:
+    // Longer messages are truncated
+    static constexpr size_t MaxMessageSize{256};
+
+    struct Entry {
+        spdlog::level::level_enum level{spdlog::level::info};
+        spdlog::log_clock::time_point time{};
+        size_t threadId{0};
+        size_t size{0};
+        std::array<char, MaxMessageSize> text{};
+    };
+
+private:
+    static constexpr std::chrono::milliseconds IdleSleep{5};
+    static constexpr std::chrono::seconds FlushInterval{3};
+
+    MpmcRingBuffer<Entry> entries;
+    const LogOverflowPolicy overflowPolicy;
+    std::shared_ptr<spdlog::sinks::sink> sink;
+    std::string loggerName;
+    std::atomic<uint64_t> droppedMessages{0};
+    std::atomic<bool> running{true};
+    std::thread writerThread;
+
+    void write(const Entry& entry) {
+        spdlog::details::log_msg message{entry.time, spdlog::source_loc{}, this->loggerName, entry.level,
+                                         spdlog::string_view_t{entry.text.data(), entry.size}};
+        // Keep thread which logged message, not writer thread
+        message.thread_id = entry.threadId;
+        this->sink->log(message);
+    }
+
+    size_t writeQueued() {
+        size_t writtenEntries{0};
+        // Entry is copied out so its slot is free again while sink writes it
+        Entry entry{};
+        while (this->entries.tryPop([&entry](Entry& queuedEntry) { entry = queuedEntry; })) {
+            this->write(entry);
+            writtenEntries++;
+        }
+        return writtenEntries;
+    }
+
+    void reportDropped(uint64_t& reportedDropped) {
+        uint64_t dropped = this->droppedMessages.load(std::memory_order_relaxed);
+        if (dropped != reportedDropped) {
+            Entry entry{};
+            entry.level = spdlog::level::warn;
+            entry.time = spdlog::log_clock::now();
+            entry.threadId = spdlog::details::os::thread_id();
+            std::string text{"AsyncLogWriter dropped " + std::to_string(dropped - reportedDropped) + " log messages"};
+            entry.size = std::min(text.size(), entry.text.size());
+            std::memcpy(entry.text.data(), text.data(), entry.size);
+            this->write(entry);
+            reportedDropped = dropped;
+        }
+    }
+
+    void run() {
+        uint64_t reportedDropped{0};
+        auto lastFlush = std::chrono::steady_clock::now();
+        while (this->running.load(std::memory_order_acquire)) {
+            if (this->writeQueued() == 0) {
+                std::this_thread::sleep_for(IdleSleep);
+            }
+            this->reportDropped(reportedDropped);
+            if (std::chrono::steady_clock::now() - lastFlush >= FlushInterval) {
+                this->sink->flush();
+                lastFlush = std::chrono::steady_clock::now();
+            }
+        }
+        this->writeQueued();
+        this->reportDropped(reportedDropped);
+        this->sink->flush();
+    }
+
+public:
+    AsyncLogWriter(std::shared_ptr<spdlog::sinks::sink> sink, std::string loggerName, const AsyncLogConfiguration& configuration)
+        : entries{configuration.queueSize}, overflowPolicy{configuration.overflowPolicy}, sink{std::move(sink)},
+          loggerName{std::move(loggerName)} {
+        writerThread = std::thread{&AsyncLogWriter::run, this};
+    }
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+
+    virtual ~AsyncLogWriter() {
+        this->running.store(false, std::memory_order_release);
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+    }
+
+    void push(spdlog::level::level_enum level, std::string_view text) {
+        auto filler = [&](Entry& entry) {
+            entry.level = level;
+            entry.time = spdlog::log_clock::now();
+            entry.threadId = spdlog::details::os::thread_id();
+            entry.size = std::min(text.size(), entry.text.size());
+            std::memcpy(entry.text.data(), text.data(), entry.size);
+        };
+        bool pushed = this->entries.tryPush(filler);
+        while (!pushed && this->overflowPolicy != LogOverflowPolicy::DropNew) {
+            if (this->overflowPolicy == LogOverflowPolicy::DropOldest) {
+                if (this->entries.tryPop([](Entry&) {})) {
+                    this->droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else {
+                std::this_thread::yield();
+            }
+            pushed = this->entries.tryPush(filler);
+        }
+        if (!pushed) {
+            this->droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] uint64_t getDroppedMessages() const { return this->droppedMessages.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+
+namespace Communication {
+
+// Per thread free lists of message body buffers, bucketed by capacity. Buffer released on other thread than
+// it was acquired on simply joins free list of releasing thread.
+class BufferPool {
+private:
+    static constexpr std::array<size_t, 4> BucketSizes{64, 256, 1024, 4096};
+    static constexpr size_t MaxBuffersPerBucket{128};
+
+    static inline thread_local std::array<std::vector<std::string>, BucketSizes.size()> buckets{};
+
+public:
+    // Buffer of given size, served from smallest bucket able to hold it
+    [[nodiscard]] static std::string acquire(size_t size) {
+        std::string buffer{};
+        size_t bucketNr{0};
+        while (bucketNr < BucketSizes.size() && BucketSizes[bucketNr] < size) {
+            bucketNr++;
+        }
+        if (bucketNr < BucketSizes.size()) {
+            auto& bucket = buckets[bucketNr];
+            if (!bucket.empty()) {
+                buffer = std::move(bucket.back());
+                bucket.pop_back();
+            } else {
+                buffer.reserve(BucketSizes[bucketNr]);
+            }
+        }
+        buffer.resize(size);
+        return buffer;
+    }
+
+    // Resizes buffer, buffer is exchanged for pooled one only if its capacity is too small
+    static void prepare(std::string& buffer, size_t size) {
+        if (buffer.capacity() < size) {
+            release(std::move(buffer));
+            buffer = acquire(size);
+        } else {
+            buffer.resize(size);
+        }
+    }
+
+    static void release(std::string&& buffer) {
+        // Buffer joins biggest bucket it is able to serve. Buffers grown beyond biggest bucket are freed,
+        // so single big message does not keep its memory pooled.
+        size_t bucketNr{buffer.capacity() > BucketSizes.back() ? 0 : BucketSizes.size()};
+        while (bucketNr > 0 && buffer.capacity() < BucketSizes[bucketNr - 1]) {
+            bucketNr--;
+        }
+        if (bucketNr > 0 && buckets[bucketNr - 1].size() < MaxBuffersPerBucket) {
+            buffer.clear();
+            buckets[bucketNr - 1].push_back(std::move(buffer));
+        }
+    }
+};
+
+} // namespace Communication
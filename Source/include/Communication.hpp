@@ -6,6 +6,7 @@
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -15,6 +16,10 @@ enum class RegistrationResponseCode : uint16_t { Success = 0, NotModuleIdentifie
 enum class ConnectResponseCode : uint16_t { Success = 0, NotModuleIdentifier, ModuleNotExists, InvalidConnectionState };
 enum class ReconnectResponseCode : uint16_t { Success = 0, NotModuleIdentifier, ModuleNotExists, InvalidConnectionState };
 
+// Operation code bit marking compact frames. Client sets it on connect or reconnect request to negotiate compact pings,
+// watchdog echoes it on response. Compact ping frame is header only, its size field carries sequence code.
+constexpr uint32_t CompactFrameFlag{0x40000000};
+
 template <typename T> struct MessageHeader {
     T operationCode;
     uint32_t size;
@@ -25,4 +30,10 @@ template <typename T> struct Message {
     std::string body{};
 };
 
+// Received message, body points into pooled buffer the request was copied to and is valid only while message is handled
+template <typename T> struct MessageView {
+    MessageHeader<T> header{};
+    std::string_view body{};
+};
+
 } // namespace Communication
\ No newline at end of file
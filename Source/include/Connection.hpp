@@ -1,186 +1,292 @@
 #pragma once
+#include "BufferPool.hpp"
 #include "Communication.hpp"
 #include "Logging.hpp"
 #include "MessageQueue.hpp"
+#include "Metrics.hpp"
+#include "ReceiveBuffer.hpp"
+#include "SpscMessageQueue.hpp"
+#include "TimerWheel.hpp"
 #include <boost/asio.hpp>
-#include <boost/bind/bind.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 namespace Connection {
 
-template <typename T> class TcpConnection : public std::enable_shared_from_this<TcpConnection<T>> {
+// All handlers of connection run on its strand, so connection state needs neither locks nor atomics.
+// Queue policy decides how outgoing messages are stored, MessageQueue grows as needed while SpscMessageQueue is bounded ring.
+template <typename T, typename Queue = MessageQueue<Communication::Message<T>>>
+class TcpConnection : public std::enable_shared_from_this<TcpConnection<T, Queue>> {
 protected:
     // Input/Output object, shared
     boost::asio::io_context& ioContext;
+    // Serializes reading, request handling, writing and timer expiration of this connection
+    boost::asio::strand<boost::asio::io_context::executor_type> strand;
     // Connection socket
     std::unique_ptr<boost::asio::ip::tcp::socket> socket = nullptr;
     // Queue of messages to send
-    MessageQueue<Communication::Message<T>> messagesQueue;
-    // Buffer message into which incoming messages will be written
-    std::unique_ptr<Communication::Message<T>> incomingMessage = nullptr;
+    Queue messagesQueue;
+    // Buffer into which incoming bytes are read, bodies of complete frames are copied out of it
+    ReceiveBuffer receiveBuffer;
+    // Bytes still missing to complete frame at front of receive buffer
+    size_t missingBytes{0};
+    // Client negotiated compact ping frames
+    bool compactPings{false};
+    // Request being handled asked for compact pings, they are enabled only once its handler accepts connection
+    bool compactPingsRequested{false};
+    // Requests decoded but not handled yet, handled one by one in order of arrival so responses keep request order
+    MessageQueue<Communication::Message<T>> pendingRequests;
+    // Verify if pending requests of this client are already being handled
+    bool processingInProgress{false};
+    // Reading is paused while too many requests are pending
+    bool readingPaused{false};
+    // Shared wheel tracking ping deadlines of all connections on this io_context
+    TimerWheel& timerWheel;
     // Wait for pings from client
-    boost::asio::deadline_timer timer;
+    TimerWheel::Timer timer;
     // Last ping timestamp
     boost::posix_time::ptime last_ping;
-    // Verify if there is already thread sending message's of this client
-    std::atomic<bool> sendingInProgress = false;
+    // Connection expires once this point passes, expiration of timer which was restarted meanwhile is not final
+    std::chrono::steady_clock::time_point timerDeadline;
+    // Verify if messages of this client are already being sent
+    bool sendingInProgress{false};
+    // Request processing waits on it while outgoing queue is full, write loop wakes it whenever it frees space
+    boost::asio::steady_timer writeProgress;
+    // Buffers of messages currently being written
+    std::vector<boost::asio::const_buffer> writeBuffers;
+    // Limits number of buffers handed to single write
+    static constexpr size_t MaxMessagesPerWrite{64};
+    // Minimal free space requested from receive buffer for single read
+    static constexpr size_t ReadChunkSize{4096};
+    // Frames announcing bigger body are treated as corrupted stream
+    static constexpr uint32_t MaxMessageBodySize{1024 * 1024};
+    // Limits requests decoded but not handled yet
+    static constexpr size_t MaxRequestsInFlight{32};
 
-    void readMessageHeader() {
-        Log::trace("TcpConnection::readMessageHeader start");
-        boost::asio::async_read(*this->socket, boost::asio::buffer(&this->incomingMessage->header, sizeof(Communication::MessageHeader<T>)),
-                                boost::bind(&TcpConnection::postReadMessageHeader, this->shared_from_this(), boost::placeholders::_1,
-                                            boost::asio::placeholders::bytes_transferred));
+    using ConnectionPointer = std::shared_ptr<TcpConnection<T, Queue>>;
+
+    // Connection is kept alive by coroutine frame, not by every asynchronous step
+    boost::asio::awaitable<void> readLoop(ConnectionPointer self) {
+        try {
+            while (this->continueReading()) {
+                // Read as much as socket has, at least enough space for rest of awaited frame
+                size_t bytesTransferred = co_await this->socket->async_read_some(
+                    this->receiveBuffer.prepare(std::max(ReadChunkSize, this->missingBytes)), boost::asio::use_awaitable);
+                this->receiveBuffer.commit(bytesTransferred);
+            }
+        } catch (boost::system::system_error& error) {
+            Log::debug("TcpConnection::readLoop: {}", error.what());
+            this->disconnect();
+        }
     }
 
-    void postReadMessageHeader(const boost::system::error_code& error, size_t bytes_transferred) {
-        if (error) {
-            Log::debug("TcpConnection::postReadMessageHeader: " + error.message());
+    // Decodes already received frames, returns true if next read should be started
+    bool continueReading() {
+        bool continueReading{false};
+        if (!this->decodeMessages()) {
             this->disconnect();
+        } else if (this->pendingRequests.size() >= MaxRequestsInFlight) {
+            this->readingPaused = true;
         } else {
-            if (bytes_transferred != sizeof(Communication::MessageHeader<T>)) {
-                Log::error("TcpConnection::postReadMessageHeader bytes read: " + std::to_string(bytes_transferred));
-            } else if (this->incomingMessage->header.size <= 0) {
-                Log::error("TcpConnection::postReadMessageHeader required empty body: " +
-                           std::to_string(this->incomingMessage->header.size));
+            continueReading = this->socket->is_open();
+        }
+        return continueReading;
+    }
+
+    // Queues every complete frame in receive buffer until in flight limit is reached, returns false if stream contains invalid frame
+    bool decodeMessages() {
+        bool decoded{true};
+        bool queuedRequests{false};
+        this->missingBytes = 0;
+        while (decoded && this->socket->is_open() && this->pendingRequests.size() < MaxRequestsInFlight &&
+               this->receiveBuffer.size() >= sizeof(Communication::MessageHeader<T>)) {
+            Communication::Message<T> request{};
+            std::memcpy(&request.header, this->receiveBuffer.data().data(), sizeof(Communication::MessageHeader<T>));
+            auto operationCode = static_cast<uint32_t>(request.header.operationCode);
+            bool compactFrame = (operationCode & Communication::CompactFrameFlag) != 0;
+            auto requestOperation = static_cast<T>(operationCode & ~Communication::CompactFrameFlag);
+            size_t frameSize = sizeof(Communication::MessageHeader<T>) + request.header.size;
+            if (compactFrame && requestOperation == T::PingRequest) {
+                if (!this->compactPings) {
+                    Log::error("TcpConnection::decodeMessages compact ping was not negotiated");
+                    decoded = false;
+                } else {
+                    // Compact ping keeps its flag, it is answered without request handlers
+                    this->receiveBuffer.consume(sizeof(Communication::MessageHeader<T>));
+                    queuedRequests = this->queueRequest(std::move(request));
+                }
+            } else if (request.header.size == 0 || request.header.size > MaxMessageBodySize) {
+                Log::error("TcpConnection::decodeMessages invalid message body size: {}", request.header.size);
+                decoded = false;
+            } else if (this->receiveBuffer.size() < frameSize) {
+                this->missingBytes = frameSize - this->receiveBuffer.size();
+                break;
             } else {
-                Log::info("Resize to: " + std::to_string(this->incomingMessage->header.size));
-                this->incomingMessage->body.resize(this->incomingMessage->header.size);
-                this->readMessageBody();
+                // Connect and reconnect keep flag until they are handled, other frames do not use it
+                if (!compactFrame || (requestOperation != T::ConnectRequest && requestOperation != T::ReconnectRequest)) {
+                    request.header.operationCode = requestOperation;
+                }
+                // Receive buffer is reused by next reads, body is copied into pooled buffer
+                request.body = Communication::BufferPool::acquire(request.header.size);
+                std::memcpy(request.body.data(), this->receiveBuffer.data().data() + sizeof(Communication::MessageHeader<T>),
+                            request.header.size);
+                this->receiveBuffer.consume(frameSize);
+                queuedRequests = this->queueRequest(std::move(request));
             }
         }
+        if (queuedRequests) {
+            this->startProcessing();
+        }
+        return decoded;
     }
 
-    void readMessageBody() {
-        Log::trace("TcpConnection::readMessageBody start");
-        // Start writing message from sending header asynchronously
-        // Once message writing is done, completion handler will be called;
-        boost::asio::async_read(*this->socket, boost::asio::buffer(this->incomingMessage->body.data(), this->incomingMessage->body.size()),
-                                boost::bind(&TcpConnection::postReadMessageBody, this->shared_from_this(), boost::placeholders::_1,
-                                            boost::asio::placeholders::bytes_transferred));
+    // Queue depth is sampled on every push, so its histogram shows how deep queues get under load
+    static Metrics::Histogram& queueDepth(const char* queue) {
+        return Metrics::Registry::get().histogram("watchdog_queue_depth", std::string{"queue=\""} + queue + "\"");
     }
 
-    void postReadMessageBody(const boost::system::error_code& error, size_t bytes_transferred) {
-        if (error) {
-            Log::debug("TcpConnection::postReadMessageHeader: " + error.message());
-            this->disconnect();
-        } else {
-            // Move message to current space to handle it
-            auto localMessage{std::move(this->incomingMessage)};
+    bool queueRequest(Communication::Message<T>&& request) {
+        static auto& pendingRequestsDepth = queueDepth("pending_requests");
+        auto requestsInQueue = this->pendingRequests.push(std::move(request));
+        pendingRequestsDepth.record(requestsInQueue);
+        return requestsInQueue > 0;
+    }
 
-            // Start handling received message here
-            this->handleReceivedMessage(std::move(localMessage));
+    void startProcessing() {
+        if (!this->processingInProgress) {
+            this->processingInProgress = true;
+            boost::asio::co_spawn(this->strand, this->processLoop(this->shared_from_this()), boost::asio::detached);
+        }
+    }
 
-            // Start reading next message
-            this->startReadingSequence();
+    boost::asio::awaitable<void> processLoop(ConnectionPointer self) {
+        while (!this->pendingRequests.empty()) {
+            // Every request is answered with at most one message, so it is handled once outgoing queue has room for it.
+            // Meanwhile pending requests reach in flight limit and reading pauses, client is slowed down instead of losing responses.
+            while (this->messagesQueue.full() && this->socket->is_open()) {
+                co_await this->waitForWriteProgress();
+            }
+            // Request stays at front of pending requests until it is handled, so its body stays valid
+            const auto& request = this->pendingRequests.front();
+            auto operationCode = static_cast<uint32_t>(request.header.operationCode);
+            bool compactFrame = (operationCode & Communication::CompactFrameFlag) != 0;
+            auto requestOperation = static_cast<T>(operationCode & ~Communication::CompactFrameFlag);
+            if (compactFrame && requestOperation == T::PingRequest) {
+                this->handleCompactPing(request.header.size);
+            } else {
+                this->compactPingsRequested = compactFrame;
+                Communication::MessageHeader<T> header{requestOperation, request.header.size};
+                co_await this->handleReceivedMessage(Communication::MessageView<T>{header, request.body});
+                this->compactPingsRequested = false;
+            }
+            this->pendingRequests.pop(1, [](Communication::Message<T>& message) {
+                Communication::BufferPool::release(std::move(message.body));
+            });
+            if (this->readingPaused && this->pendingRequests.size() < MaxRequestsInFlight) {
+                this->readingPaused = false;
+                boost::asio::co_spawn(this->strand, this->readLoop(self), boost::asio::detached);
+            }
+            // Let other connections run between requests
+            co_await boost::asio::post(this->strand, boost::asio::use_awaitable);
         }
+        this->processingInProgress = false;
     }
 
-    void writeMessageHeader() {
-        Log::trace("TcpConnection::writeMessageHeader start");
-        if (socket) {
-            boost::asio::async_write(*this->socket,
-                                     boost::asio::buffer(&this->messagesQueue.front().header, sizeof(Communication::MessageHeader<T>)),
-                                     boost::bind(&TcpConnection::postWriteMessageHeader, this->shared_from_this(),
-                                                 boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+    boost::asio::awaitable<void> waitForWriteProgress() {
+        static auto& outgoingQueueFull = Metrics::Registry::get().counter("watchdog_outgoing_queue_full_total");
+        outgoingQueueFull.add();
+        this->writeProgress.expires_at(boost::asio::steady_timer::time_point::max());
+        boost::system::error_code error{};
+        // Wait ends when write loop cancels it
+        co_await this->writeProgress.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    }
+
+    boost::asio::awaitable<void> writeLoop(ConnectionPointer self) {
+        try {
+            while (!this->messagesQueue.empty()) {
+                // Headers and bodies of all queued messages are gathered into single write
+                this->writeBuffers.clear();
+                auto gatherMessage = [this](const Communication::Message<T>& message) {
+                    this->writeBuffers.emplace_back(&message.header, sizeof(Communication::MessageHeader<T>));
+                    if (!message.body.empty()) {
+                        this->writeBuffers.emplace_back(message.body.data(), message.body.size());
+                    }
+                };
+                size_t messagesInWrite = this->messagesQueue.peek(MaxMessagesPerWrite, gatherMessage);
+                co_await boost::asio::async_write(*this->socket, this->writeBuffers, boost::asio::use_awaitable);
+                // Remove from queue messages which we just sent
+                this->messagesQueue.pop(messagesInWrite, [](Communication::Message<T>& message) {
+                    Communication::BufferPool::release(std::move(message.body));
+                });
+                this->writeProgress.cancel();
+            }
+        } catch (boost::system::system_error& error) {
+            Log::debug("TcpConnection::writeLoop: {}", error.what());
+            this->disconnect();
         }
+        this->sendingInProgress = false;
+        // Processing waiting for space must learn that connection was closed
+        this->writeProgress.cancel();
     }
 
     void blockingWriteMessageHeader() {
         Log::trace("TcpConnection::writeMessageHeader start");
         if (socket) {
-            Log::trace("TcpConnection::blockingWriteMessageHeader size: " + std::to_string(this->messagesQueue.front().header.size));
+            Log::trace("TcpConnection::blockingWriteMessageHeader size: {}", this->messagesQueue.front().header.size);
             boost::asio::write(*this->socket,
                                boost::asio::buffer(&this->messagesQueue.front().header, sizeof(Communication::MessageHeader<T>)));
         }
     }
 
-    void postWriteMessageHeader(const boost::system::error_code& error, size_t bytes_transferred) {
-        if (error) {
-            Log::debug("TcpConnection::postWriteMessageHeader" + error.message());
-            this->disconnect();
-            this->sendingInProgress = false;
-        } else if (bytes_transferred != sizeof(Communication::MessageHeader<T>)) {
-            Log::error("TcpConnection::postWriteMessageHeader bytes write: " + std::to_string(bytes_transferred));
-            // try to send header once again because not whole header has been sent
-            this->writeMessageHeader();
-        } else {
-            Log::debug("TcpConnection::postWriteMessageHeader try to send message body");
-            // Check if there is something in message body to send
-            if (this->messagesQueue.front().body.size() > 0) {
-                // Start sending message body
-                this->writeMessageBody();
-            } else {
-                Log::debug("TcpConnection::postReadMessageHeader message body is empty");
-                // If message body was empty just pop it out from queue
-                this->messagesQueue.pop();
-                // Check if there are more messages to send, if there are keep sending
-                if (!this->messagesQueue.empty()) {
-                    this->writeMessageHeader();
-                }
-            }
+    // Compact ping is answered here, without protobuf and request handlers
+    void handleCompactPing(uint32_t sequenceCode) {
+        static auto& compactPings = Metrics::Registry::get().counter("watchdog_compact_pings_total");
+        compactPings.add();
+        if (this->acceptPing(sequenceCode)) {
+            Communication::Message<T> response{};
+            response.header.operationCode = static_cast<T>(T::PingResponse | Communication::CompactFrameFlag);
+            response.header.size = sequenceCode;
+            this->sendMessage(std::move(response));
         }
     }
 
-    void writeMessageBody() {
-        Log::trace("TcpConnection::writeMessageBody start");
-        boost::asio::async_write(*this->socket,
-                                 boost::asio::buffer(this->messagesQueue.front().body.data(), this->messagesQueue.front().body.size()),
-                                 boost::bind(&TcpConnection::postWriteMessageBody, this->shared_from_this(),
-                                             boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
-    }
-
-    void postWriteMessageBody(const boost::system::error_code& error, size_t bytes_transferred) {
-        if (error) {
-            Log::debug("TcpConnection::postWriteMessageBody: " + error.message());
-            this->disconnect();
-            this->sendingInProgress = false;
-        } else {
-            // Remove from queue message which we just sent
-            this->messagesQueue.pop();
-
-            // Check if there are more messages to send, if there are keep sending
-            if (!this->messagesQueue.empty()) {
-                this->writeMessageHeader();
-            } else {
-                this->sendingInProgress = false;
-            }
+    // Called by connection which accepted connect or reconnect request, before its response is sent
+    void enableRequestedCompactPings() {
+        if (this->compactPingsRequested) {
+            this->compactPings = true;
         }
     }
 
     void timerExpired() { this->onTimerExpiration(); }
-    virtual void handleReceivedMessage(std::unique_ptr<Communication::Message<T>> receivedMessage) = 0;
+    // Next pending request is handled once returned coroutine completes
+    virtual boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<T> receivedMessage) = 0;
     virtual void onTimerExpiration() = 0;
+    // Verifies ping sequence code and restarts ping timer
+    virtual bool acceptPing(uint32_t sequenceCode) = 0;
 
 public:
-    explicit TcpConnection(boost::asio::io_context& ioContext) : ioContext{ioContext}, timer{ioContext} {
+    TcpConnection(boost::asio::io_context& ioContext, TimerWheel& timerWheel)
+        : ioContext{ioContext}, strand{boost::asio::make_strand(ioContext)}, timerWheel{timerWheel}, writeProgress{strand} {
         socket = std::make_unique<boost::asio::ip::tcp::socket>(ioContext);
         Log::debug("TcpConnection::TcpConnection created");
     }
-    virtual ~TcpConnection() { Log::debug("TcpConnection::TcpConnection dead"); }
+    virtual ~TcpConnection() {
+        this->timerWheel.cancel(this->timer);
+        Log::debug("TcpConnection::TcpConnection dead");
+    }
     [[nodiscard]] constexpr boost::asio::ip::tcp::socket& getSocket() { return *this->socket; }
 
     bool isConnected() { return this->socket->is_open(); }
 
     void startReading() {
         last_ping = boost::posix_time::microsec_clock::local_time();
-        this->startReadingSequence();
-    }
-
-    void startReadingSequence() {
-        // Make sure of that there are no existing message buffer
-        if (this->incomingMessage) {
-            Log::debug("TcpConnection::startReadingSequence message buffer was not released before retrying");
-            incomingMessage.reset();
-        }
-        Log::trace("Allocating new message");
-        try {
-            incomingMessage = std::make_unique<Communication::Message<T>>();
-        } catch (std::exception& ex) {
-            Log::trace("Allocating new message ex: " + std::string(ex.what()));
-        }
-
-        this->readMessageHeader();
+        boost::asio::co_spawn(this->strand, this->readLoop(this->shared_from_this()), boost::asio::detached);
     }
 
     virtual void disconnect() {
@@ -195,17 +301,30 @@ public:
         }
     }
 
-    void sendMessage(Communication::Message<T>& message) {
-        auto messagesInQueue = this->messagesQueue.push(message);
-        if (!this->socket) {
+    // Message is moved into queue together with its body buffer, body is recycled once message is sent
+    void sendMessage(Communication::Message<T>&& message) {
+        if (this->compactPings &&
+            (message.header.operationCode == T::ConnectResponse || message.header.operationCode == T::ReconnectResponse)) {
+            // Confirm compact pings negotiation
+            message.header.operationCode = static_cast<T>(message.header.operationCode | Communication::CompactFrameFlag);
+        }
+        static auto& outgoingDepth = queueDepth("outgoing");
+        static auto& droppedMessages = Metrics::Registry::get().counter("watchdog_dropped_responses_total");
+        auto messagesInQueue = this->messagesQueue.push(std::move(message));
+        outgoingDepth.record(messagesInQueue);
+        if (messagesInQueue == 0) {
+            // Processing waits for free space while connection is open, so only closing connection drops messages
+            droppedMessages.add();
+            Log::debug("TcpConnection::sendMessage messages queue of closed connection is full, message dropped");
+        } else if (!this->socket) {
             Log::error("TcpConnection::sendMessage socket was nullptr");
         } else if (!this->socket->is_open()) {
             Log::debug("TcpConnection::sendMessage connection is not open");
-        } else if (sendingInProgress) {
-            Log::debug("TcpConnection::sendMessage there is already sending thread running");
+        } else if (this->sendingInProgress) {
+            Log::debug("TcpConnection::sendMessage messages are already being sent");
         } else {
             this->sendingInProgress = true;
-            this->writeMessageHeader();
+            boost::asio::co_spawn(this->strand, this->writeLoop(this->shared_from_this()), boost::asio::detached);
         }
     }
 
@@ -215,7 +334,7 @@ public:
             try {
                 this->socket->connect(endpoint);
             } catch (std::exception& ex) {
-                Log::critical("TcpConnection::connect failed to connect with err: " + std::string(ex.what()));
+                Log::critical("TcpConnection::connect failed to connect with err: {}", ex.what());
                 connected = false;
             }
         } else {
@@ -224,11 +343,33 @@ public:
         return connected;
     }
 
-    void setTimerExpiration(size_t microsec) {
-        this->timer.expires_from_now(boost::posix_time::millisec(microsec));
-        this->timer.async_wait(boost::bind(&TcpConnection::timerExpired, this->shared_from_this()));
+    void setTimerExpiration(size_t millisec) {
+        last_ping = boost::posix_time::microsec_clock::local_time();
+        this->timerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{millisec};
+        this->scheduleTimer(std::chrono::milliseconds{millisec});
     }
 
+    // Returns true once timer deadline passed, otherwise timer is scheduled again for remaining time
+    bool timerDeadlinePassed() {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(this->timerDeadline - std::chrono::steady_clock::now());
+        bool passed{remaining.count() <= 0};
+        if (!passed) {
+            this->scheduleTimer(remaining);
+        }
+        return passed;
+    }
+
+    void scheduleTimer(std::chrono::milliseconds timeout) {
+        // Wheel must not keep connection alive, expired timer of destroyed connection is ignored
+        this->timerWheel.schedule(this->timer, timeout, [weakConnection = this->weak_from_this()]() {
+            if (auto connection = weakConnection.lock()) {
+                boost::asio::dispatch(connection->strand, [connection]() { connection->timerExpired(); });
+            }
+        });
+    }
+
+    void cancelTimer() { this->timerWheel.cancel(this->timer); }
+
     void makeNewSocket() {
         socket.reset();
         socket = std::make_unique<boost::asio::ip::tcp::socket>(ioContext);
@@ -0,0 +1,58 @@
+#pragma once
+#include "TimerWheel.hpp"
+#include "WatchdogConfiguration.hpp"
+#include <atomic>
+#include <boost/asio.hpp>
+#include <memory>
+#include <vector>
+
+namespace Watchdog {
+
+// Set of io_contexts (shards) connections are spread over. With one shard all working threads share
+// single io_context, otherwise every working thread runs its own shard.
+class IoContextPool {
+public:
+    struct Shard {
+        boost::asio::io_context ioContext;
+        // Ping deadlines of all connections served by this shard
+        Connection::TimerWheel timerWheel;
+        // Connections currently served by this shard
+        std::atomic<size_t> connections{0};
+        // Time last probe waited in queue of this io_context before it was run
+        std::atomic<int64_t> loopLagNanoseconds{0};
+
+        explicit Shard(int concurrencyHint) : ioContext{concurrencyHint}, timerWheel{ioContext} {}
+    };
+
+private:
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> workGuards;
+    ConnectionsDispatch connectionsDispatch;
+    std::atomic<size_t> nextShard{0};
+
+    Shard& selectShard();
+
+public:
+    IoContextPool(size_t shardsCount, ConnectionsDispatch connectionsDispatch);
+    IoContextPool(const IoContextPool&) = delete;
+    virtual ~IoContextPool() = default;
+
+    [[nodiscard]] size_t size() const { return shards.size(); }
+    [[nodiscard]] Shard& getShard(size_t shardNr) { return *shards[shardNr % shards.size()]; }
+    void stop();
+    // Posts probe to every shard measuring how long handlers wait before they run, result is read on next probe
+    void probeLoopLag();
+
+    // Creates connection on selected shard, shard load is released together with connection
+    template <typename ConnectionType, typename... Args> std::shared_ptr<ConnectionType> makeConnection(Args&... args) {
+        auto& shard = this->selectShard();
+        shard.connections.fetch_add(1, std::memory_order_relaxed);
+        return std::shared_ptr<ConnectionType>(new ConnectionType(shard.ioContext, shard.timerWheel, args...),
+                                               [&shard](ConnectionType* connection) {
+                                                   delete connection;
+                                                   shard.connections.fetch_sub(1, std::memory_order_relaxed);
+                                               });
+    }
+};
+
+} // namespace Watchdog
@@ -1,17 +1,53 @@
 #pragma once
+#include "AsyncLogWriter.hpp"
+#include "spdlog/fmt/fmt.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/spdlog.h"
 #include <iostream>
+#include <iterator>
 #include <string>
-#include <type_traits>
+#include <string_view>
+#include <utility>
+
+// Lowest level which is compiled in, calls below it are removed entirely. Values follow Log::LogLevel,
+// level is set only by LOG_LEVEL option of CMakeLists.txt.
+#ifndef WATCHDOG_LOG_LEVEL
+#error "WATCHDOG_LOG_LEVEL is not defined, it is set by LOG_LEVEL option of CMakeLists.txt"
+#endif
 
 class Log {
 public:
     enum class LogLevel : uint8_t { TRACE, DEBUG, INFO, WARNING, ERROR, CRITICAL };
+    static constexpr LogLevel CompiledLevel{static_cast<LogLevel>(WATCHDOG_LOG_LEVEL)};
 
 private:
     static inline std::unique_ptr<Log> instance = nullptr;
     std::shared_ptr<spdlog::logger> logger = nullptr;
+    std::unique_ptr<AsyncLogWriter> asyncWriter = nullptr;
+
+    static void write(spdlog::level::level_enum spdlogLevel, std::string_view message) {
+        if (instance->asyncWriter) {
+            instance->asyncWriter->push(spdlogLevel, message);
+        } else {
+            instance->logger->log(spdlogLevel, message);
+        }
+    }
+
+    template <LogLevel Level, typename... Args>
+    static void log(spdlog::level::level_enum spdlogLevel, spdlog::format_string_t<Args...> format, Args&&... args) {
+        if constexpr (Level >= CompiledLevel) {
+            if (instance && instance->logger->should_log(spdlogLevel)) {
+                if constexpr (sizeof...(Args) == 0) {
+                    auto message = fmt::string_view{format};
+                    Log::write(spdlogLevel, std::string_view{message.data(), message.size()});
+                } else {
+                    fmt::memory_buffer message{};
+                    fmt::format_to(std::back_inserter(message), format, std::forward<Args>(args)...);
+                    Log::write(spdlogLevel, std::string_view{message.data(), message.size()});
+                }
+            }
+        }
+    }
 
     spdlog::level::level_enum translateToSpdlogLevel(LogLevel& logLevel) {
         spdlog::level::level_enum spdlogLevel{};
@@ -54,45 +90,37 @@ public:
         }
     }
 
-    template <typename T> static void trace(T message) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->trace(message);
+    // Hands writing to background thread, messages logged by other threads may not be interleaved with the switch
+    static void startAsync(const AsyncLogConfiguration& configuration) {
+        if (instance && !instance->asyncWriter) {
+            instance->asyncWriter =
+                std::make_unique<AsyncLogWriter>(instance->logger->sinks().front(), instance->logger->name(), configuration);
         }
     }
 
-    template <typename T> static void trace(T message, T functionName) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->trace(message);
-        }
+    [[nodiscard]] static uint64_t droppedMessages() {
+        return instance && instance->asyncWriter ? instance->asyncWriter->getDroppedMessages() : 0;
     }
 
-    template <typename T> static void debug(T message) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->debug(message);
-        }
+    // Message is formatted only when level is enabled, arguments are substituted into {} placeholders.
+    // Format string is checked against arguments at compile time.
+    template <typename... Args> static void trace(spdlog::format_string_t<Args...> format, Args&&... args) {
+        Log::log<LogLevel::TRACE>(spdlog::level::trace, format, std::forward<Args>(args)...);
     }
 
-    template <typename T> static void info(T message) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->info(message);
-        }
+    template <typename... Args> static void debug(spdlog::format_string_t<Args...> format, Args&&... args) {
+        Log::log<LogLevel::DEBUG>(spdlog::level::debug, format, std::forward<Args>(args)...);
     }
 
-    template <typename T> static void error(T message) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->error(message);
-        }
+    template <typename... Args> static void info(spdlog::format_string_t<Args...> format, Args&&... args) {
+        Log::log<LogLevel::INFO>(spdlog::level::info, format, std::forward<Args>(args)...);
     }
 
-    template <typename T> static void critical(T message) {
-        static_assert(std::is_convertible<T, std::string>::value, "Message is not trivially convertible to std::string");
-        if (instance) {
-            instance->logger->critical(message);
-        }
+    template <typename... Args> static void error(spdlog::format_string_t<Args...> format, Args&&... args) {
+        Log::log<LogLevel::ERROR>(spdlog::level::err, format, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args> static void critical(spdlog::format_string_t<Args...> format, Args&&... args) {
+        Log::log<LogLevel::CRITICAL>(spdlog::level::critical, format, std::forward<Args>(args)...);
     }
 };
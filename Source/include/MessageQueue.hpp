@@ -1,11 +1,12 @@
 #pragma once
-#include <mutex>
-#include <queue>
+#include <algorithm>
+#include <deque>
 
+// Unbounded queue of messages, owner has to serialize access to it (connection does so with its strand)
 template <typename T> class MessageQueue {
 private:
-    mutable std::mutex queueLock;
-    std::queue<T> messagesQueue;
+    // Deque keeps references to queued messages valid while new messages are pushed
+    std::deque<T> messagesQueue;
 
 public:
     MessageQueue() = default;
@@ -13,30 +14,35 @@ public:
     virtual ~MessageQueue() = default;
 
     [[nodiscard]] size_t push(const T& message) {
-        std::scoped_lock lock(this->queueLock);
-        this->messagesQueue.push(message);
+        this->messagesQueue.push_back(message);
         return this->messagesQueue.size();
     }
 
     [[nodiscard]] size_t push(T&& message) {
-        std::scoped_lock lock(this->queueLock);
-        this->messagesQueue.push(std::move(message));
+        this->messagesQueue.push_back(std::move(message));
         return this->messagesQueue.size();
     }
-    [[nodiscard]] const T& front() {
-        std::scoped_lock lock(this->queueLock);
-        return this->messagesQueue.front();
+    [[nodiscard]] const T& front() { return this->messagesQueue.front(); }
+    // Visits up to maxCount messages from front of queue, returns number of visited messages
+    template <typename Visitor> size_t peek(size_t maxCount, Visitor&& visitor) const {
+        size_t count = std::min(maxCount, this->messagesQueue.size());
+        for (size_t messageNr = 0; messageNr < count; messageNr++) {
+            visitor(this->messagesQueue[messageNr]);
+        }
+        return count;
     }
-    void pop() {
-        std::scoped_lock lock(this->queueLock);
-        this->messagesQueue.pop();
+    void pop() { this->messagesQueue.pop_front(); }
+    void pop(size_t count) { this->pop(count, [](T&) {}); }
+    // Removes count messages from front of queue, recycler may take over resources of each removed message
+    template <typename Recycler> void pop(size_t count, Recycler&& recycler) {
+        count = std::min(count, this->messagesQueue.size());
+        for (size_t messageNr = 0; messageNr < count; messageNr++) {
+            recycler(this->messagesQueue[messageNr]);
+        }
+        this->messagesQueue.erase(std::begin(this->messagesQueue), std::next(std::begin(this->messagesQueue), count));
     }
-    [[nodiscard]] size_t size() const {
-        std::scoped_lock lock(this->queueLock);
-        return this->messagesQueue.size();
-    }
-    [[nodiscard]] bool empty() const {
-        std::scoped_lock lock(this->queueLock);
-        return this->messagesQueue.empty();
-    }
-};
\ No newline at end of file
+    [[nodiscard]] size_t size() const { return this->messagesQueue.size(); }
+    [[nodiscard]] bool empty() const { return this->messagesQueue.empty(); }
+    // Queue grows as needed
+    [[nodiscard]] bool full() const { return false; }
+};
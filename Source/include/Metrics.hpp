@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Metrics {
+
+// Metrics are written by many threads and read rarely. Every writing thread owns its own slot of each metric,
+// so recording is single uncontended relaxed atomic operation, reader merges slots of all threads.
+static constexpr size_t MaxThreadSlots{64};
+
+// Slot of calling thread, threads above MaxThreadSlots share slots, which stays correct as slots are atomic
+inline size_t threadSlot() {
+    static std::atomic<size_t> nextSlot{0};
+    static thread_local size_t slot{nextSlot.fetch_add(1, std::memory_order_relaxed) % MaxThreadSlots};
+    return slot;
+}
+
+// Monotonic count or up and down gauge
+class Counter {
+private:
+    struct alignas(64) Slot {
+        std::atomic<int64_t> value{0};
+    };
+    std::array<Slot, MaxThreadSlots> slots{};
+
+public:
+    void add(int64_t value = 1) { slots[threadSlot()].value.fetch_add(value, std::memory_order_relaxed); }
+    void sub(int64_t value = 1) { slots[threadSlot()].value.fetch_sub(value, std::memory_order_relaxed); }
+
+    [[nodiscard]] int64_t value() const {
+        int64_t sum{0};
+        for (const auto& slot : slots) {
+            sum += slot.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+};
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count{0};
+    uint64_t sum{0};
+
+    // Upper bound of bucket holding given quantile (0.0 - 1.0) of recorded values
+    [[nodiscard]] uint64_t quantile(double quantile) const;
+};
+
+// Log-linear (HDR style) histogram: values are grouped by power of two, each power is split into SubBuckets
+// linear buckets, so relative error stays below 1 / SubBuckets over whole uint64_t range.
+class Histogram {
+public:
+    static constexpr size_t SubBucketBits{3};
+    static constexpr size_t SubBuckets{1 << SubBucketBits};
+    static constexpr size_t BucketsCount{(64 - SubBucketBits + 1) * SubBuckets};
+
+    [[nodiscard]] static constexpr size_t bucketIndex(uint64_t value) {
+        size_t index{value};
+        if (value >= SubBuckets) {
+            size_t exponent = std::bit_width(value) - 1;
+            size_t subBucket = (value >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+            index = (exponent - SubBucketBits + 1) * SubBuckets + subBucket;
+        }
+        return index;
+    }
+
+    // Smallest value falling into bucket
+    [[nodiscard]] static constexpr uint64_t bucketLowerBound(size_t index) {
+        uint64_t bound{index};
+        if (index >= SubBuckets) {
+            size_t exponent = index / SubBuckets + SubBucketBits - 1;
+            bound = (SubBuckets + index % SubBuckets) << (exponent - SubBucketBits);
+        }
+        return bound;
+    }
+
+    [[nodiscard]] static constexpr uint64_t bucketUpperBound(size_t index) {
+        return index + 1 < BucketsCount ? bucketLowerBound(index + 1) - 1 : UINT64_MAX;
+    }
+
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, BucketsCount> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+    };
+    // Shards are allocated by first record of thread, threads which never record cost nothing
+    std::array<std::atomic<Shard*>, MaxThreadSlots> shards{};
+
+    Shard& getShard() {
+        auto& shardPointer = shards[threadSlot()];
+        Shard* shard = shardPointer.load(std::memory_order_acquire);
+        if (shard == nullptr) {
+            auto newShard = std::make_unique<Shard>();
+            if (shardPointer.compare_exchange_strong(shard, newShard.get(), std::memory_order_acq_rel)) {
+                shard = newShard.release();
+            }
+        }
+        return *shard;
+    }
+
+public:
+    Histogram() = default;
+    Histogram(const Histogram&) = delete;
+    ~Histogram() {
+        for (auto& shard : shards) {
+            delete shard.load(std::memory_order_relaxed);
+        }
+    }
+
+    void record(uint64_t value) {
+        auto& shard = this->getShard();
+        shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+};
+
+// Records time elapsed from construction to destruction in nanoseconds
+class ScopedTimer {
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Histogram& histogram) : histogram{histogram}, start{std::chrono::steady_clock::now()} {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - this->start;
+        this->histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+};
+
+// Named metrics of whole process. Registration takes lock and is meant for startup or function local statics,
+// recording goes straight to returned metric. Labels are kept in prometheus form, e.g. operation="PingRequest".
+class Registry {
+public:
+    struct Key {
+        std::string name;
+        std::string labels;
+
+        bool operator<(const Key& other) const { return name < other.name || (name == other.name && labels < other.labels); }
+    };
+
+    using CounterVisitor = std::function<void(const Key&, const Counter&)>;
+    using HistogramVisitor = std::function<void(const Key&, const Histogram&)>;
+
+private:
+    mutable std::mutex lock;
+    std::map<Key, std::unique_ptr<Counter>> counters;
+    std::map<Key, std::unique_ptr<Histogram>> histograms;
+
+public:
+    static Registry& get() {
+        static Registry registry{};
+        return registry;
+    }
+
+    // Same name and labels always give the same metric
+    Counter& counter(std::string name, std::string labels = {});
+    Histogram& histogram(std::string name, std::string labels = {});
+
+    void visitCounters(const CounterVisitor& visitor) const;
+    void visitHistograms(const HistogramVisitor& visitor) const;
+};
+
+// Writes metrics in prometheus text exposition format. Samples of the same name have to be written one after another,
+// # TYPE line is written before first of them.
+class PrometheusWriter {
+private:
+    std::string text;
+    std::string currentName;
+
+    void writeType(std::string_view name, std::string_view type);
+    void writeSample(std::string_view name, std::string_view labels, std::string_view extraLabel, std::string_view value);
+
+public:
+    void gauge(std::string_view name, std::string_view labels, int64_t value);
+    void counter(std::string_view name, std::string_view labels, uint64_t value);
+    // Counters named *_total are written as counters, other counters as gauges, histograms as summaries with p50, p99 and p999
+    void registry(const Registry& registry);
+
+    [[nodiscard]] const std::string& getText() const { return text; }
+};
+
+} // namespace Metrics
@@ -0,0 +1,32 @@
+#pragma once
+#include "MongoModulesCollection.hpp"
+#include "MongoServicesCollection.hpp"
+#include <memory>
+#include <mongocxx/pool.hpp>
+
+namespace Mongo {
+
+// Database client and collections owned by single thread. Thread creates its context before it starts
+// handling any work, afterwards context is reachable without touching data shared with other threads.
+class DbContext {
+private:
+    mongocxx::pool::entry clientEntry;
+    ModulesCollection modulesCollection;
+    ServicesCollection servicesCollection;
+
+    static inline thread_local std::unique_ptr<DbContext> threadContext = nullptr;
+
+public:
+    explicit DbContext(mongocxx::pool::entry clientEntry);
+    DbContext(const DbContext&) = delete;
+    ~DbContext() = default;
+
+    static bool initialize();
+    static void release();
+    [[nodiscard]] static DbContext* get() { return threadContext.get(); }
+
+    [[nodiscard]] ModulesCollection& getModulesCollection() { return modulesCollection; }
+    [[nodiscard]] ServicesCollection& getServicesCollection() { return servicesCollection; }
+};
+
+} // namespace Mongo
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <fstream>
 #include <memory>
 #include <mongocxx/client.hpp>
@@ -42,10 +43,14 @@ class DbEnvironment {
 private:
     mongocxx::instance mongoInstance{};
     mongocxx::pool clientsPool;
+    // Clients taken from pool and not returned yet
+    std::atomic<size_t> clientsInUse{0};
 
     static inline std::unique_ptr<DbEnvironment> instance = nullptr;
     static inline std::mutex mongoEnvironmentLock;
 
+    static bool hasIndex(mongocxx::collection& collection, std::string_view indexName);
+
 public:
     DbEnvironment(std::string address);
     ~DbEnvironment() = default;
@@ -53,8 +58,11 @@ public:
 
     static constexpr std::unique_ptr<DbEnvironment>& getInstance() { return instance; };
     mongocxx::pool::entry getClient();
+    [[nodiscard]] size_t getClientsInUse() const { return clientsInUse.load(std::memory_order_relaxed); }
 
     [[nodiscard]] static bool isConnected();
+    // Creates indexes used by collections lookups, returns false if any unique index is missing afterwards
+    [[nodiscard]] static bool ensureIndexes();
 };
 
 } // namespace Mongo
\ No newline at end of file
@@ -1,30 +1,43 @@
 #pragma once
+#include "MongoRecordUpdate.hpp"
 #include "Types.hpp"
 #include <boost/asio.hpp>
 #include <mongocxx/client.hpp>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace Mongo {
 
 class ModulesCollection {
 private:
     mongocxx::collection modulesCollection;
-    std::optional<ModuleRecord> viewToModuleRecord(bsoncxx::document::view&);
+    RecordUpdateBuilder<ModuleRecord> updateBuilder{"ModuleIdentifier"};
+    bsoncxx::document::value identifiersFilter(std::span<const Types::ModuleIdentifier> moduleIdentifiers);
 
 public:
     ModulesCollection(mongocxx::client& client, std::string collectionName);
     virtual ~ModulesCollection() = default;
 
+    // Conversions between record and its stored document
+    static bsoncxx::document::value moduleRecordToDocument(const ModuleRecord& record);
+    static std::optional<ModuleRecord> viewToModuleRecord(const bsoncxx::document::view& view);
+
     bool insertOne(ModuleRecord&& record);
+    bool insertMany(std::vector<ModuleRecord>&& records);
     bool findOne(Types::ModuleIdentifier& moduleIdentifier);
     void deleteOne(Types::ModuleIdentifier& moduleIdentifier);
+    bool deleteMany(std::span<const Types::ModuleIdentifier> moduleIdentifiers);
     bool setDisconnected(Types::ModuleIdentifier& moduleIdentifier);
     [[nodiscard]] bool setAllAsRegistered();
     std::optional<ModuleRecord> getModule(Types::ModuleIdentifier& moduleIdentifier);
     std::optional<ModuleRecord> getModule(const Types::ModuleIdentifier& moduleIdentifier);
+    std::vector<ModuleRecord> getModules(std::span<const Types::ModuleIdentifier> moduleIdentifiers);
     void drop();
     std::vector<ModuleRecord> getAllModules();
-    bool updateModule(ModuleRecord&& record);
+    bool updateModule(ModuleRecord&& record, Types::RecordField fields = Types::RecordField::All);
+    bool updateMany(std::span<const ModuleRecord> records);
+    bool updateMany(std::span<const RecordUpdate<ModuleRecord>> updates);
 
     bool markAllConnectedAsDisconnected();
 };
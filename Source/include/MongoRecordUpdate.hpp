@@ -0,0 +1,52 @@
+#pragma once
+#include "Types.hpp"
+#include <bsoncxx/builder/core.hpp>
+#include <bsoncxx/document/view.hpp>
+
+namespace Mongo {
+
+template <typename Record> struct RecordUpdate {
+    Record record;
+    Types::RecordField fields{Types::RecordField::All};
+};
+
+// Builds filter and $set documents of record update containing only changed fields. Builders are cleared,
+// not recreated, so their buffers are reused by subsequent updates. Views are valid until next build.
+template <typename Record> class RecordUpdateBuilder {
+private:
+    const char* identifierField;
+    bsoncxx::builder::core filterBuilder{false};
+    bsoncxx::builder::core updateBuilder{false};
+
+public:
+    explicit RecordUpdateBuilder(const char* identifierField) : identifierField{identifierField} {}
+    RecordUpdateBuilder(const RecordUpdateBuilder&) = delete;
+
+    void build(const Record& record, Types::RecordField fields) {
+        this->filterBuilder.clear();
+        this->filterBuilder.key_view(this->identifierField);
+        this->filterBuilder.append(record.identifier);
+
+        this->updateBuilder.clear();
+        this->updateBuilder.key_view("$set");
+        this->updateBuilder.open_document();
+        if (Types::hasField(fields, Types::RecordField::ConnectionState)) {
+            this->updateBuilder.key_view("ConnectionState");
+            this->updateBuilder.append(static_cast<int32_t>(record.connectionState));
+        }
+        if (Types::hasField(fields, Types::RecordField::IpAddress)) {
+            this->updateBuilder.key_view("IpAddress");
+            this->updateBuilder.append(std::string_view{record.ipAddress});
+        }
+        if (Types::hasField(fields, Types::RecordField::Port)) {
+            this->updateBuilder.key_view("Port");
+            this->updateBuilder.append(static_cast<int32_t>(record.port));
+        }
+        this->updateBuilder.close_document();
+    }
+
+    [[nodiscard]] bsoncxx::document::view filter() const { return this->filterBuilder.view_document(); }
+    [[nodiscard]] bsoncxx::document::view update() const { return this->updateBuilder.view_document(); }
+};
+
+} // namespace Mongo
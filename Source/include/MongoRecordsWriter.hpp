@@ -0,0 +1,178 @@
+#pragma once
+#include "Logging.hpp"
+#include "MongoDbEnvironment.hpp"
+#include "MongoModulesCollection.hpp"
+#include "MongoRecordUpdate.hpp"
+#include "MongoServicesCollection.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mongo {
+
+// Persists records on its own thread, so io_context threads never wait for database.
+// Changes of the same record waiting for flush are coalesced, newest record is written with all fields changed meanwhile.
+// Pending records are flushed as one ordered bulk write once batch is full or deadline passed.
+// Updates of failed bulk are retried with growing delay, merged with changes of the same records made meanwhile.
+template <typename Collection, typename Record> class RecordsWriter {
+public:
+    // Writes one ordered bulk of updates, returns false if it was not persisted
+    using BatchWriter = std::function<bool(std::span<const RecordUpdate<Record>>)>;
+    // Called on writer thread, so database client taken by returned writer is used only by that thread
+    using BatchWriterFactory = std::function<BatchWriter()>;
+
+private:
+    using Identifier = decltype(Record::identifier);
+
+    static constexpr std::chrono::milliseconds MaxRetryDelay{5000};
+
+    std::string collectionName;
+    const size_t batchSize;
+    const std::chrono::milliseconds flushDelay;
+    // Delay before first retry of failed bulk, every next failure doubles it
+    const std::chrono::milliseconds retryDelay;
+    BatchWriterFactory writerFactory;
+    mutable std::mutex lock;
+    std::condition_variable condition;
+    // Records in order of their first change, index keeps position of every identifier
+    std::vector<RecordUpdate<Record>> pendingRecords;
+    std::unordered_map<Identifier, size_t> pendingIndexes;
+    std::chrono::steady_clock::time_point flushDeadline;
+    bool running{true};
+    std::thread writerThread;
+
+    // Returns updates of bulks which failed, so they can be retried
+    std::vector<RecordUpdate<Record>> writeBatch(const BatchWriter& writer, std::vector<RecordUpdate<Record>>& records) {
+        std::vector<RecordUpdate<Record>> failedRecords{};
+        for (size_t offset = 0; offset < records.size(); offset += batchSize) {
+            auto recordsInBatch = std::min(batchSize, records.size() - offset);
+            if (!writer(std::span<const RecordUpdate<Record>>{records.data() + offset, recordsInBatch})) {
+                Log::error("RecordsWriter::writeBatch failed to write {} records to {}", recordsInBatch, collectionName);
+                failedRecords.insert(std::end(failedRecords), std::next(std::begin(records), offset),
+                                     std::next(std::begin(records), offset + recordsInBatch));
+            }
+        }
+        return failedRecords;
+    }
+
+    // Coalesces update with pending update of the same record, newer record is kept with fields of both. Lock is held by caller.
+    void queue(RecordUpdate<Record>&& update) {
+        if (auto pending = this->pendingIndexes.find(update.record.identifier); pending != std::end(this->pendingIndexes)) {
+            auto& pendingRecord = this->pendingRecords[pending->second];
+            pendingRecord.record = std::move(update.record);
+            pendingRecord.fields = pendingRecord.fields | update.fields;
+        } else {
+            this->pendingIndexes.emplace(update.record.identifier, this->pendingRecords.size());
+            this->pendingRecords.push_back(std::move(update));
+        }
+    }
+
+    // Failed updates are written again ahead of records changed meanwhile. Lock is held by caller.
+    void requeue(std::vector<RecordUpdate<Record>>&& failedRecords) {
+        std::vector<RecordUpdate<Record>> newerRecords{};
+        newerRecords.swap(this->pendingRecords);
+        this->pendingIndexes.clear();
+        for (auto& update : failedRecords) {
+            this->queue(std::move(update));
+        }
+        for (auto& update : newerRecords) {
+            this->queue(std::move(update));
+        }
+    }
+
+    void run() {
+        auto writer = this->writerFactory();
+        auto nextRetryDelay = this->retryDelay;
+
+        std::vector<RecordUpdate<Record>> recordsToWrite{};
+        std::unique_lock<std::mutex> guard(this->lock);
+        while (this->running || !this->pendingRecords.empty()) {
+            this->condition.wait(guard, [this]() { return !this->running || !this->pendingRecords.empty(); });
+            // Give other changes chance to join this batch
+            this->condition.wait_until(guard, this->flushDeadline,
+                                       [this]() { return !this->running || this->pendingRecords.size() >= this->batchSize; });
+            recordsToWrite.swap(this->pendingRecords);
+            this->pendingIndexes.clear();
+            guard.unlock();
+
+            auto failedRecords = this->writeBatch(writer, recordsToWrite);
+            recordsToWrite.clear();
+
+            guard.lock();
+            if (failedRecords.empty()) {
+                nextRetryDelay = this->retryDelay;
+            } else if (!this->running) {
+                Log::error("RecordsWriter::run dropped {} records not written to {} before shutdown", failedRecords.size(),
+                           collectionName);
+            } else {
+                this->requeue(std::move(failedRecords));
+                // Database is given time to recover, shutdown ends waiting and makes last attempt
+                this->condition.wait_for(guard, nextRetryDelay, [this]() { return !this->running; });
+                nextRetryDelay = std::min(nextRetryDelay * 2, MaxRetryDelay);
+                this->flushDeadline = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+public:
+    explicit RecordsWriter(std::string collectionName, size_t batchSize = 500,
+                           std::chrono::milliseconds flushDelay = std::chrono::milliseconds{50},
+                           std::chrono::milliseconds retryDelay = std::chrono::milliseconds{100})
+        : RecordsWriter{collectionName,
+                        [collectionName]() -> BatchWriter {
+                            auto clientEntry = std::make_shared<mongocxx::pool::entry>(DbEnvironment::getInstance()->getClient());
+                            auto collection = std::make_shared<Collection>(**clientEntry, collectionName);
+                            return [clientEntry, collection](std::span<const RecordUpdate<Record>> records) {
+                                return collection->updateMany(records);
+                            };
+                        },
+                        batchSize, flushDelay, retryDelay} {}
+
+    RecordsWriter(std::string collectionName, BatchWriterFactory writerFactory, size_t batchSize, std::chrono::milliseconds flushDelay,
+                  std::chrono::milliseconds retryDelay)
+        : collectionName{std::move(collectionName)}, batchSize{batchSize}, flushDelay{flushDelay}, retryDelay{retryDelay},
+          writerFactory{std::move(writerFactory)} {
+        pendingRecords.reserve(batchSize);
+        writerThread = std::thread{&RecordsWriter::run, this};
+    }
+    RecordsWriter(const RecordsWriter&) = delete;
+
+    virtual ~RecordsWriter() {
+        {
+            std::scoped_lock guard(this->lock);
+            this->running = false;
+        }
+        this->condition.notify_one();
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+    }
+
+    void push(const Record& record, Types::RecordField fields = Types::RecordField::All) {
+        bool notify{false};
+        {
+            std::scoped_lock guard(this->lock);
+            if (this->pendingRecords.empty()) {
+                this->flushDeadline = std::chrono::steady_clock::now() + this->flushDelay;
+                notify = true;
+            }
+            this->queue(RecordUpdate<Record>{record, fields});
+            notify = notify || this->pendingRecords.size() >= this->batchSize;
+        }
+        if (notify) {
+            this->condition.notify_one();
+        }
+    }
+};
+
+typedef RecordsWriter<ModulesCollection, ModuleRecord> ModulesWriter;
+typedef RecordsWriter<ServicesCollection, ServiceRecord> ServicesWriter;
+
+} // namespace Mongo
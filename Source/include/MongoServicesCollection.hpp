@@ -1,25 +1,36 @@
 #pragma once
+#include "MongoRecordUpdate.hpp"
 #include "Types.hpp"
 #include <boost/asio.hpp>
 #include <mongocxx/client.hpp>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace Mongo {
 
 class ServicesCollection {
 private:
     mongocxx::collection servicesCollection;
+    RecordUpdateBuilder<ServiceRecord> updateBuilder{"ServiceIdentifier"};
 
     std::optional<ServiceRecord> viewToServiceRecord(bsoncxx::document::view&);
+    bsoncxx::document::value identifiersFilter(std::span<const Types::ServiceIdentifier> serviceIdentifiers);
 
 public:
     ServicesCollection(mongocxx::client& client, std::string collectionName);
     virtual ~ServicesCollection() = default;
 
     bool insertOne(ServiceRecord&& record);
+    bool insertMany(std::vector<ServiceRecord>&& records);
     std::optional<ServiceRecord> getService(const Types::ServiceIdentifier& moduleIdentifier);
-    bool updateService(ServiceRecord&& record);
+    std::vector<ServiceRecord> getServices(std::span<const Types::ServiceIdentifier> serviceIdentifiers);
+    bool updateService(ServiceRecord&& record, Types::RecordField fields = Types::RecordField::All);
+    bool updateMany(std::span<const ServiceRecord> records);
+    bool updateMany(std::span<const RecordUpdate<ServiceRecord>> updates);
+    bool deleteMany(std::span<const Types::ServiceIdentifier> serviceIdentifiers);
     void drop();
+    std::vector<ServiceRecord> getAllServices();
 
     bool markAllConnectedAsDisconnected();
 };
@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for many producers and many consumers. Every slot carries sequence number telling
+// whether it is free for producer of given position or filled for consumer of it, so claiming position
+// with single compare-exchange is enough and nobody takes a lock. Slots are allocated once, up front.
+template <typename T> class MpmcRingBuffer {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    const size_t capacity;
+    const size_t indexMask;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t rounded{1};
+        while (rounded < value) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+public:
+    // Capacity is rounded up to power of two
+    explicit MpmcRingBuffer(size_t requestedCapacity)
+        : capacity{roundUpToPowerOfTwo(std::max<size_t>(requestedCapacity, 2))}, indexMask{capacity - 1},
+          slots{std::make_unique<Slot[]>(capacity)} {
+        for (size_t slotNr = 0; slotNr < capacity; slotNr++) {
+            slots[slotNr].sequence.store(slotNr, std::memory_order_relaxed);
+        }
+    }
+    MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+    virtual ~MpmcRingBuffer() = default;
+
+    // Claims free slot and lets filler write value in place, returns false if queue is full
+    template <typename Filler> [[nodiscard]] bool tryPush(Filler&& filler) {
+        bool pushed{false};
+        size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = this->slots[position & this->indexMask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    filler(slot.value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    pushed = true;
+                    break;
+                }
+            } else if (difference < 0) {
+                // Slot still holds value from previous turn of ring
+                break;
+            } else {
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        return pushed;
+    }
+
+    // Hands oldest value to consumer and frees its slot, returns false if queue is empty
+    template <typename Consumer> [[nodiscard]] bool tryPop(Consumer&& consumer) {
+        bool popped{false};
+        size_t position = this->dequeuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = this->slots[position & this->indexMask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (this->dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    consumer(slot.value);
+                    slot.sequence.store(position + this->capacity, std::memory_order_release);
+                    popped = true;
+                    break;
+                }
+            } else if (difference < 0) {
+                break;
+            } else {
+                position = this->dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        return popped;
+    }
+
+    [[nodiscard]] size_t getCapacity() const { return this->capacity; }
+};
@@ -0,0 +1,169 @@
+#pragma once
+#include "Types.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Watchdog {
+
+enum class TransitionResult { Transitioned, NotFound, InvalidState };
+
+// In-memory records of programs, placed in front of mongodb collections. Records are spread over
+// independently locked shards, every modification is handed to write-through callback to be persisted.
+// Callback is called under shard lock, so changes of one record reach it in the order they were applied;
+// it has to be quick (e.g. queue record for writing) and must not call back into registry.
+// Identifiers which loader did not find are remembered for short time, so repeated requests of unknown
+// programs do not query database every time.
+template <typename T> class ProgramRegistry {
+public:
+    using Record = Types::ProgramRecord<T>;
+    using ConnectionState = typename Record::ConnectionState;
+    // Fetches record from database when it is not cached yet (e.g. registered after startup)
+    using Loader = std::function<std::optional<Record>(const T&)>;
+    // Receives copy of every modified record together with fields which were changed
+    using WriteThrough = std::function<void(const Record&, Types::RecordField)>;
+
+private:
+    static constexpr size_t ShardsCount = 16;
+    // Expired misses are purged once shard remembers this many of them
+    static constexpr size_t MaxMissesPerShard = 1024;
+
+    struct Shard {
+        mutable std::mutex lock;
+        std::unordered_map<T, Record> records;
+        // Identifiers not found by loader, with time until which they are not looked up again
+        std::unordered_map<T, std::chrono::steady_clock::time_point> misses;
+    };
+
+    std::array<Shard, ShardsCount> shards;
+    Loader loader;
+    WriteThrough writeThrough;
+    const std::chrono::milliseconds missTimeToLive;
+
+    Shard& getShard(const T& identifier) { return shards[static_cast<size_t>(identifier) % ShardsCount]; }
+
+    // Lock of shard is held by caller
+    void rememberMiss(Shard& shard, const T& identifier) {
+        auto now = std::chrono::steady_clock::now();
+        if (shard.misses.size() >= MaxMissesPerShard) {
+            std::erase_if(shard.misses, [now](const auto& miss) { return miss.second <= now; });
+        }
+        shard.misses.insert_or_assign(identifier, now + this->missTimeToLive);
+    }
+
+public:
+    ProgramRegistry(Loader loader, WriteThrough writeThrough, std::chrono::milliseconds missTimeToLive = std::chrono::seconds{1})
+        : loader{std::move(loader)}, writeThrough{std::move(writeThrough)}, missTimeToLive{missTimeToLive} {}
+    ProgramRegistry(const ProgramRegistry&) = delete;
+    virtual ~ProgramRegistry() = default;
+
+    void load(std::vector<Record>&& records) {
+        for (auto& record : records) {
+            auto& shard = getShard(record.identifier);
+            std::scoped_lock lock(shard.lock);
+            shard.misses.erase(record.identifier);
+            shard.records.insert_or_assign(record.identifier, std::move(record));
+        }
+    }
+
+    [[nodiscard]] std::optional<Record> get(const T& identifier) {
+        auto& shard = getShard(identifier);
+        {
+            std::scoped_lock lock(shard.lock);
+            if (auto found = shard.records.find(identifier); found != std::end(shard.records)) {
+                return found->second;
+            }
+            if (auto miss = shard.misses.find(identifier); miss != std::end(shard.misses)) {
+                if (miss->second > std::chrono::steady_clock::now()) {
+                    return std::nullopt;
+                }
+                shard.misses.erase(miss);
+            }
+        }
+
+        std::optional<Record> record{std::nullopt};
+        if (loader) {
+            record = loader(identifier);
+            std::scoped_lock lock(shard.lock);
+            if (record.has_value()) {
+                // Someone could update record while it was loading, his version is newer
+                auto [cached, inserted] = shard.records.try_emplace(identifier, *record);
+                record = cached->second;
+            } else if (auto cached = shard.records.find(identifier); cached != std::end(shard.records)) {
+                // Record was added while loader was looking for it
+                record = cached->second;
+            } else {
+                this->rememberMiss(shard, identifier);
+            }
+        }
+        return record;
+    }
+
+    bool update(Record&& record) {
+        auto& shard = getShard(record.identifier);
+        std::scoped_lock lock(shard.lock);
+        shard.misses.erase(record.identifier);
+        auto [stored, inserted] = shard.records.insert_or_assign(record.identifier, std::move(record));
+        if (writeThrough) {
+            writeThrough(stored->second, Types::RecordField::All);
+        }
+        return true;
+    }
+
+    // Compare-and-set of connection state under shard lock, so two requests for the same record can not
+    // both observe old state and both succeed
+    TransitionResult transition(const T& identifier, std::initializer_list<ConnectionState> expectedStates, ConnectionState newState) {
+        TransitionResult result{TransitionResult::NotFound};
+        // Brings record to cache when it is not there yet
+        if (this->get(identifier).has_value()) {
+            auto& shard = getShard(identifier);
+            std::scoped_lock lock(shard.lock);
+            if (auto found = shard.records.find(identifier); found != std::end(shard.records)) {
+                if (std::find(std::begin(expectedStates), std::end(expectedStates), found->second.connectionState) ==
+                    std::end(expectedStates)) {
+                    result = TransitionResult::InvalidState;
+                } else {
+                    found->second.connectionState = newState;
+                    result = TransitionResult::Transitioned;
+                    if (writeThrough) {
+                        writeThrough(found->second, Types::RecordField::ConnectionState);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] size_t size() const {
+        size_t recordsCount{0};
+        for (auto& shard : shards) {
+            std::scoped_lock lock(shard.lock);
+            recordsCount += shard.records.size();
+        }
+        return recordsCount;
+    }
+
+    // Shards are counted one after another, so counts are consistent per shard only
+    [[nodiscard]] std::map<ConnectionState, size_t> countByState() const {
+        std::map<ConnectionState, size_t> statesCount{};
+        for (auto& shard : shards) {
+            std::scoped_lock lock(shard.lock);
+            for (const auto& [identifier, record] : shard.records) {
+                statesCount[record.connectionState]++;
+            }
+        }
+        return statesCount;
+    }
+};
+
+typedef ProgramRegistry<Types::ModuleIdentifier> ModulesRegistry;
+typedef ProgramRegistry<Types::ServiceIdentifier> ServicesRegistry;
+
+} // namespace Watchdog
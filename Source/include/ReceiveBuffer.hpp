@@ -0,0 +1,48 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Connection {
+
+// Per connection receive buffer. Socket reads append behind unread bytes, decoded frames are consumed from
+// front. Unread tail is moved to beginning only when there is not enough space left for next read.
+class ReceiveBuffer {
+private:
+    std::vector<char> storage;
+    size_t readOffset{0};
+    size_t writeOffset{0};
+
+public:
+    explicit ReceiveBuffer(size_t capacity = 4096) : storage(capacity) {}
+    ReceiveBuffer(const ReceiveBuffer&) = delete;
+    virtual ~ReceiveBuffer() = default;
+
+    // Free space for next read, at least minimumSize bytes
+    [[nodiscard]] boost::asio::mutable_buffer prepare(size_t minimumSize) {
+        if (storage.size() - writeOffset < minimumSize) {
+            if (readOffset > 0) {
+                std::memmove(storage.data(), storage.data() + readOffset, writeOffset - readOffset);
+                writeOffset -= readOffset;
+                readOffset = 0;
+            }
+            if (storage.size() - writeOffset < minimumSize) {
+                storage.resize(writeOffset + minimumSize);
+            }
+        }
+        return boost::asio::buffer(storage.data() + writeOffset, storage.size() - writeOffset);
+    }
+    void commit(size_t size) { writeOffset += size; }
+    void consume(size_t size) {
+        readOffset += size;
+        if (readOffset >= writeOffset) {
+            readOffset = 0;
+            writeOffset = 0;
+        }
+    }
+    [[nodiscard]] std::string_view data() const { return std::string_view{storage.data() + readOffset, writeOffset - readOffset}; }
+    [[nodiscard]] size_t size() const { return writeOffset - readOffset; }
+};
+
+} // namespace Connection
@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Bounded lock-free queue for single producer and single consumer. Messages are stored in contiguous ring
+// of Capacity slots, producer owns tail and consumer owns head so neither side ever takes a lock.
+template <typename T, size_t Capacity = 256> class SpscMessageQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscMessageQueue capacity must be power of two");
+
+private:
+    static constexpr size_t IndexMask{Capacity - 1};
+    std::vector<T> slots;
+    // Next slot to consume, written only by consumer
+    alignas(64) std::atomic<size_t> head{0};
+    // Next slot to fill, written only by producer
+    alignas(64) std::atomic<size_t> tail{0};
+
+    template <typename Message> [[nodiscard]] size_t emplace(Message&& message) {
+        size_t currentTail = this->tail.load(std::memory_order_relaxed);
+        size_t currentHead = this->head.load(std::memory_order_acquire);
+        size_t queuedMessages{0};
+        if (currentTail - currentHead < Capacity) {
+            this->slots[currentTail & IndexMask] = std::forward<Message>(message);
+            this->tail.store(currentTail + 1, std::memory_order_release);
+            queuedMessages = currentTail + 1 - currentHead;
+        }
+        return queuedMessages;
+    }
+
+public:
+    SpscMessageQueue() : slots(Capacity) {}
+    SpscMessageQueue(const SpscMessageQueue<T, Capacity>&) = delete;
+    virtual ~SpscMessageQueue() = default;
+
+    // Producer side, returns number of queued messages or 0 if queue was full and message was not queued
+    [[nodiscard]] size_t push(const T& message) { return this->emplace(message); }
+    [[nodiscard]] size_t push(T&& message) { return this->emplace(std::move(message)); }
+
+    // Consumer side
+    [[nodiscard]] const T& front() { return this->slots[this->head.load(std::memory_order_relaxed) & IndexMask]; }
+    // Visits up to maxCount messages from front of queue, returns number of visited messages
+    template <typename Visitor> size_t peek(size_t maxCount, Visitor&& visitor) const {
+        size_t currentHead = this->head.load(std::memory_order_relaxed);
+        size_t count = std::min(maxCount, this->tail.load(std::memory_order_acquire) - currentHead);
+        for (size_t messageNr = 0; messageNr < count; messageNr++) {
+            visitor(this->slots[(currentHead + messageNr) & IndexMask]);
+        }
+        return count;
+    }
+    void pop() { this->pop(1); }
+    void pop(size_t count) { this->pop(count, [](T&) {}); }
+    // Removes count messages from front of queue, recycler may take over resources of each removed message
+    template <typename Recycler> void pop(size_t count, Recycler&& recycler) {
+        size_t currentHead = this->head.load(std::memory_order_relaxed);
+        count = std::min(count, this->tail.load(std::memory_order_acquire) - currentHead);
+        for (size_t messageNr = 0; messageNr < count; messageNr++) {
+            auto& message = this->slots[(currentHead + messageNr) & IndexMask];
+            recycler(message);
+            // Release memory still held by removed message
+            message = T{};
+        }
+        this->head.store(currentHead + count, std::memory_order_release);
+    }
+
+    [[nodiscard]] size_t size() const { return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire); }
+    [[nodiscard]] bool empty() const { return this->size() == 0; }
+    [[nodiscard]] bool full() const { return this->size() >= Capacity; }
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <thread>
+#include <vector>
+
+namespace Watchdog {
+
+// Threads doing blocking mongodb work on behalf of connections. Every thread owns its own database context,
+// network threads post storage work here and are resumed once it is done.
+class StorageExecutor {
+private:
+    boost::asio::io_context ioContext;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> workGuard;
+    std::vector<std::thread> storageThreads;
+
+public:
+    explicit StorageExecutor(size_t threadsCount);
+    StorageExecutor(const StorageExecutor&) = delete;
+    virtual ~StorageExecutor();
+
+    template <typename Work> void post(Work&& work) { boost::asio::post(this->ioContext, std::forward<Work>(work)); }
+    [[nodiscard]] boost::asio::io_context::executor_type getExecutor() { return this->ioContext.get_executor(); }
+    void stop();
+};
+
+} // namespace Watchdog
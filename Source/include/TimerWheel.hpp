@@ -0,0 +1,63 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Connection {
+
+// Hashed timing wheel shared by all connections of one io_context. Timers are kept in intrusive lists,
+// one per slot, so (re)scheduling only relinks timer in O(1). Single coarse tick sweeps expired timers.
+class TimerWheel {
+public:
+    class Timer {
+    private:
+        friend class TimerWheel;
+        Timer* previous{nullptr};
+        Timer* next{nullptr};
+        uint64_t expirationTick{0};
+        std::function<void()> onExpiration;
+
+    public:
+        Timer() = default;
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        [[nodiscard]] bool isScheduled() const { return previous != nullptr; }
+    };
+
+private:
+    const std::chrono::milliseconds tickDuration;
+    mutable std::mutex lock;
+    // Sentinels of circular timers lists
+    std::vector<Timer> slots;
+    uint64_t currentTick{0};
+    size_t scheduledTimers{0};
+    std::chrono::steady_clock::time_point startTime;
+    boost::asio::steady_timer tickTimer;
+    bool running{false};
+
+    [[nodiscard]] uint64_t expirationTickAfter(std::chrono::milliseconds timeout) const;
+    void link(Timer& timer);
+    void unlink(Timer& timer);
+    void waitForTick();
+    void onTick(const boost::system::error_code& error);
+
+public:
+    explicit TimerWheel(boost::asio::io_context& ioContext, std::chrono::milliseconds tickDuration = std::chrono::milliseconds{100},
+                        size_t slotsCount = 512);
+    TimerWheel(const TimerWheel&) = delete;
+    virtual ~TimerWheel() = default;
+
+    void start();
+    void stop();
+
+    // Timer expires not earlier than after timeout, rescheduling already scheduled timer moves it and replaces
+    // its handler. Handler is installed and taken out of timer only under wheel lock.
+    void schedule(Timer& timer, std::chrono::milliseconds timeout, std::function<void()> onExpiration);
+    void cancel(Timer& timer);
+    [[nodiscard]] size_t size() const;
+};
+
+} // namespace Connection
@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <string>
 
 namespace Types {
 
@@ -30,6 +31,17 @@ union IdentifierUnion {
     return identifierUnion.identifier;
 }
 
+// Mask of record fields changed since record was persisted last time
+enum class RecordField : uint8_t { None = 0, ConnectionState = 1 << 0, IpAddress = 1 << 1, Port = 1 << 2, All = 0x07 };
+
+[[nodiscard]] constexpr RecordField operator|(RecordField first, RecordField second) {
+    return static_cast<RecordField>(static_cast<uint8_t>(first) | static_cast<uint8_t>(second));
+}
+
+[[nodiscard]] constexpr bool hasField(RecordField fields, RecordField field) {
+    return (static_cast<uint8_t>(fields) & static_cast<uint8_t>(field)) != 0;
+}
+
 template <typename T> struct ProgramRecord {
     enum class ConnectionState : int32_t { Registered, Connected, Disconnected };
     uint16_t port{};
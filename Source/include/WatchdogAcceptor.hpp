@@ -1,23 +1,29 @@
 #pragma once
 #include "Communication.hpp"
-#include "MongoModulesCollection.hpp"
-#include "MongoServicesCollection.hpp"
+#include "IoContextPool.hpp"
+#include "Metrics.hpp"
+#include "ProgramRegistry.hpp"
+#include "StorageExecutor.hpp"
 #include "WatchdogConnection.hpp"
 #include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <thread>
 
 namespace Watchdog {
 
 class ModulesAcceptor {
 private:
-    boost::asio::io_context& ioContext;
-    std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection;
-    std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection;
+    IoContextPool& ioContextPool;
+    ModulesRegistry& modulesRegistry;
+    ServicesRegistry& servicesRegistry;
+    StorageExecutor& storageExecutor;
     std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor = nullptr;
 
 public:
-    ModulesAcceptor(boost::asio::io_context& ioContext, std::map<std::thread::id, Mongo::ModulesCollection>&,
-                    std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection);
+    ModulesAcceptor(IoContextPool& ioContextPool, ModulesRegistry& modulesRegistry, ServicesRegistry& servicesRegistry,
+                    StorageExecutor& storageExecutor);
     virtual ~ModulesAcceptor() = default;
 
     void startAcceptingConnections();
@@ -26,18 +32,50 @@ public:
 
 class ServicesAcceptor {
 private:
-    boost::asio::io_context& ioContext;
-    std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection;
-    std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection;
+    IoContextPool& ioContextPool;
+    ModulesRegistry& modulesRegistry;
+    ServicesRegistry& servicesRegistry;
+    StorageExecutor& storageExecutor;
     std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor{nullptr};
 
 public:
-    explicit ServicesAcceptor(boost::asio::io_context&, std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection,
-                              std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection);
+    ServicesAcceptor(IoContextPool& ioContextPool, ModulesRegistry& modulesRegistry, ServicesRegistry& servicesRegistry,
+                     StorageExecutor& storageExecutor);
     virtual ~ServicesAcceptor() = default;
 
     void startAcceptingServices();
     void serviceAccepted(std::shared_ptr<ServiceConnection> newServiceSession, const boost::system::error_code& error);
 };
 
+// Serves metrics snapshot in prometheus text format over plain HTTP, bound to loopback only.
+// Runs its own io_context on its own thread, so scraping never delays client connections.
+class AdminAcceptor {
+public:
+    // Writes metrics which are not kept in metrics registry (registries, shards, pools)
+    using Collector = std::function<void(Metrics::PrometheusWriter&)>;
+
+private:
+    boost::asio::io_context ioContext{1};
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor{nullptr};
+    Collector collector;
+    std::thread thread;
+    // Requests are not parsed, only their headers are read to the end
+    static constexpr size_t MaxRequestSize{8192};
+    // Delay before accepting again after transient error, doubled with every consecutive error
+    static constexpr std::chrono::milliseconds InitialAcceptRetryDelay{10};
+    static constexpr std::chrono::milliseconds MaxAcceptRetryDelay{1000};
+
+    static bool isTransientAcceptError(const boost::system::error_code& error);
+    boost::asio::awaitable<void> acceptLoop();
+    boost::asio::awaitable<void> serve(boost::asio::ip::tcp::socket socket);
+
+public:
+    explicit AdminAcceptor(Collector collector);
+    AdminAcceptor(const AdminAcceptor&) = delete;
+    virtual ~AdminAcceptor();
+
+    bool start(uint16_t port);
+    void stop();
+};
+
 } // namespace Watchdog
\ No newline at end of file
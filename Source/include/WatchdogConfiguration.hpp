@@ -0,0 +1,48 @@
+#pragma once
+#include "AsyncLogWriter.hpp"
+#include <cstdint>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace Watchdog {
+
+enum class ConnectionsDispatch : uint8_t { RoundRobin, LeastLoad };
+
+struct ServerConfiguration {
+    // Number of threads running io_context, hardware_concurrency when not configured
+    size_t workingThreads;
+    // Give every working thread its own io_context instead of sharing one between all of them
+    bool ioContextPerThread{false};
+    // How accepted connections are spread over io_contexts when each thread has its own
+    ConnectionsDispatch connectionsDispatch{ConnectionsDispatch::RoundRobin};
+    // Pin n-th working thread to n-th cpu
+    bool pinThreads{false};
+    // Number of threads doing blocking mongodb work, separate from working threads
+    size_t storageThreads{2};
+    // Log messages are written to file by background thread, other threads only queue them
+    bool asyncLog{false};
+    AsyncLogConfiguration asyncLogConfiguration{};
+    // Serve metrics snapshot over HTTP on loopback port
+    bool adminEndpoint{false};
+    uint16_t adminPort{1236};
+
+    ServerConfiguration();
+};
+
+class ServerConfigurationReader {
+private:
+    ServerConfiguration& serverConfiguration;
+    const std::string configurationPath{"/opt/ProcessManager/WatchdogConfiguration.json"};
+    std::ifstream configFile;
+    nlohmann::json jsonConfig;
+
+    bool read();
+
+public:
+    explicit ServerConfigurationReader(ServerConfiguration&);
+    ~ServerConfigurationReader();
+    bool readConfiguration();
+};
+
+} // namespace Watchdog
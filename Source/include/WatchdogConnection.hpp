@@ -2,57 +2,80 @@
 #include "Communication.hpp"
 #include "Connection.hpp"
 #include "Logging.hpp"
-#include "MongoModulesCollection.hpp"
-#include "MongoServicesCollection.hpp"
+#include "ProgramRegistry.hpp"
+#include "StorageExecutor.hpp"
 #include "WatchdogModule.pb.h"
 #include "WatchdogModuleRequestsHandlers.hpp"
 #include "WatchdogService.pb.h"
 #include "WatchdogServiceRequestsHandlers.hpp"
+#include <array>
 #include <boost/asio.hpp>
 #include <iostream>
+#include <optional>
 
 namespace Watchdog {
 
-class ModuleConnection : public Connection::TcpConnection<WatchdogModule::Operation> {
+// Responses of single connection are produced sequentially by its read path, so outgoing queue can be lock-free
+template <typename Operation>
+using WatchdogTcpConnection = Connection::TcpConnection<Operation, SpscMessageQueue<Communication::Message<Operation>>>;
+
+class ModuleConnection : public WatchdogTcpConnection<WatchdogModule::Operation> {
 protected:
     uint32_t sequenceCode{};
     ModuleAuthenticationData authenticationData{};
-    std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection;
-    std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection;
-    boost::asio::deadline_timer timer;
+    // Copy of authenticationData storage bound handlers work on, it is applied back on strand once handler completes
+    ModuleAuthenticationData storageAuthenticationData{};
+    // Set by storage bound handler which connected module, ping timer is started back on strand
+    bool storageTimerRequested{false};
+    ModulesRegistry& modulesRegistry;
+    ServicesRegistry& servicesRegistry;
+    StorageExecutor& storageExecutor;
     boost::asio::ip::tcp::endpoint clientEndpoint;
+    // Handlers created once per connection, indexed by request operation code
+    std::array<std::unique_ptr<ModuleRequestHandler>, WatchdogModule::Operation_ARRAYSIZE> requestHandlers{};
 
     void onTimerExpiration() override;
-    void createMessageResponse(std::unique_ptr<ModuleRequestHandler>, std::string& messageBody);
+    bool acceptPing(uint32_t sequenceCode) override;
+    std::optional<Communication::Message<WatchdogModule::Operation>> createMessageResponse(ModuleRequestHandler&,
+                                                                                           std::string_view messageBody);
 
-    std::unique_ptr<ModuleRequestHandler> getRequestHandler(const WatchdogModule::Operation&, Mongo::ModulesCollection&);
+    ModuleRequestHandler* getRequestHandler(const WatchdogModule::Operation&);
+    void applyStorageResult();
 
 public:
-    ModuleConnection(boost::asio::io_context& ioContext, std::map<std::thread::id, Mongo::ModulesCollection>&,
-                     std::map<std::thread::id, Mongo::ServicesCollection>&);
-    ~ModuleConnection() override { Log::debug("Module connection terminated"); }
+    ModuleConnection(boost::asio::io_context& ioContext, Connection::TimerWheel&, ModulesRegistry&, ServicesRegistry&, StorageExecutor&);
+    ~ModuleConnection() override;
 
-    void handleReceivedMessage(std::unique_ptr<Communication::Message<WatchdogModule::Operation>> receivedMessage) override;
+    boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<WatchdogModule::Operation> receivedMessage) override;
     void disconnect() override;
 
     void setTimerWaitForConnection();
 };
 
-class ServiceConnection : public Connection::TcpConnection<WatchdogService::Operation> {
+class ServiceConnection : public WatchdogTcpConnection<WatchdogService::Operation> {
 protected:
-    std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection;
-    std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection;
-    ServiceAuthenticationData serviceAuthenticationData;
+    ModulesRegistry& modulesRegistry;
+    ServicesRegistry& servicesRegistry;
+    StorageExecutor& storageExecutor;
+    ServiceAuthenticationData serviceAuthenticationData{};
+    // Copy of serviceAuthenticationData storage bound handlers work on, it is applied back on strand once handler completes
+    ServiceAuthenticationData storageAuthenticationData{};
+    // Set by storage bound handler which connected service, ping timer is started back on strand
+    bool storageTimerRequested{false};
+    // Handlers created once per connection, indexed by request operation code
+    std::array<std::unique_ptr<ServiceRequestHandler>, WatchdogService::Operation_ARRAYSIZE> requestHandlers{};
 
-    void handleReceivedMessage(std::unique_ptr<Communication::Message<WatchdogService::Operation>> receivedMessage) override;
+    boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<WatchdogService::Operation> receivedMessage) override;
     void onTimerExpiration() override;
+    bool acceptPing(uint32_t sequenceCode) override;
 
-    void createMessageResponse(std::unique_ptr<ServiceRequestHandler>, std::string& messageBody);
-    std::unique_ptr<ServiceRequestHandler> getRequestHandler(const WatchdogService::Operation&, Mongo::ServicesCollection&);
+    std::optional<Communication::Message<WatchdogService::Operation>> createMessageResponse(ServiceRequestHandler&,
+                                                                                            std::string_view messageBody);
+    ServiceRequestHandler* getRequestHandler(const WatchdogService::Operation&);
+    void applyStorageResult();
 
 public:
-    explicit ServiceConnection(boost::asio::io_context& ioContext, std::map<std::thread::id, Mongo::ModulesCollection>&,
-                               std::map<std::thread::id, Mongo::ServicesCollection>&);
+    ServiceConnection(boost::asio::io_context& ioContext, Connection::TimerWheel&, ModulesRegistry&, ServicesRegistry&, StorageExecutor&);
     void disconnect() override;
     ~ServiceConnection() override;
 };
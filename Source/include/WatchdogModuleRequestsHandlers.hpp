@@ -1,7 +1,9 @@
 #pragma once
+#include "BufferPool.hpp"
 #include "Communication.hpp"
-#include "MongoModulesCollection.hpp"
+#include "ProgramRegistry.hpp"
 #include "Types.hpp"
+#include <string_view>
 #include "WatchdogModule.pb.h"
 
 namespace Watchdog {
@@ -21,6 +23,8 @@ private:
 public:
     explicit ModuleRequestHandlerException(ErrorCode errorCode) { this->errorCode = errorCode; }
     ~ModuleRequestHandlerException() override = default;
+
+    [[nodiscard]] ErrorCode getErrorCode() const { return this->errorCode; }
 };
 
 class ModuleRequestHandler {
@@ -29,17 +33,21 @@ protected:
     Communication::Message<WatchdogModule::Operation> responseMessage{};
 
     uint32_t generateNewSequenceCode(uint32_t oldSequenceCode = 0);
+    // Serializes response into pooled body buffer of response message, buffer is moved out with returned response
+    void setResponseBody(const google::protobuf::MessageLite& response);
 
 public:
     explicit ModuleRequestHandler(ModuleAuthenticationData& authenticationData);
-    virtual ~ModuleRequestHandler() = default;
+    virtual ~ModuleRequestHandler() { Communication::BufferPool::release(std::move(this->responseMessage.body)); }
 
-    [[nodiscard]] virtual Communication::Message<WatchdogModule::Operation> createResponse(std::string& receivedRequest) = 0;
+    [[nodiscard]] virtual Communication::Message<WatchdogModule::Operation> createResponse(std::string_view receivedRequest) = 0;
+    // Handlers touching database are run on storage executor instead of network thread
+    [[nodiscard]] virtual bool requiresStorage() const { return false; }
 };
 
 class ModuleConnectRequestHandler : public ModuleRequestHandler {
 protected:
-    Mongo::ModulesCollection& modulesCollection;
+    ModulesRegistry& modulesRegistry;
     std::function<void()> timerControl;
     WatchdogModule::ConnectRequestData connectRequest;
     WatchdogModule::ConnectResponseData connectResponse;
@@ -47,10 +55,11 @@ protected:
     void processConnectRequest();
 
 public:
-    ModuleConnectRequestHandler(ModuleAuthenticationData&, Mongo::ModulesCollection&, std::function<void()> timerControl);
+    ModuleConnectRequestHandler(ModuleAuthenticationData&, ModulesRegistry&, std::function<void()> timerControl);
     ~ModuleConnectRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string& receivedRequest) override;
+    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string_view receivedRequest) override;
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 class ModulePingRequestHandler : public ModuleRequestHandler {
@@ -63,12 +72,12 @@ public:
     ModulePingRequestHandler(ModuleAuthenticationData&, std::function<void()>);
     ~ModulePingRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string& receivedRequest) override;
+    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string_view receivedRequest) override;
 };
 
 class ModuleReconnectRequestHandler : public ModuleRequestHandler {
 protected:
-    Mongo::ModulesCollection& modulesCollection;
+    ModulesRegistry& modulesRegistry;
     std::function<void()> timerControl;
     WatchdogModule::ReconnectRequestData reconnectRequest;
     WatchdogModule::ReconnectResponseData reconnectResponse;
@@ -76,24 +85,26 @@ protected:
     void processReconnectRequest();
 
 public:
-    ModuleReconnectRequestHandler(ModuleAuthenticationData&, Mongo::ModulesCollection&, std::function<void()>);
+    ModuleReconnectRequestHandler(ModuleAuthenticationData&, ModulesRegistry&, std::function<void()>);
     ~ModuleReconnectRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string& receivedRequest) override;
+    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string_view receivedRequest) override;
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 class ModuleShutdownRequestHandler : public ModuleRequestHandler {
 protected:
-    Mongo::ModulesCollection& modulesCollection;
+    ModulesRegistry& modulesRegistry;
     WatchdogModule::ShutdownRequestData shutdownRequest;
 
     void processShutdownRequest();
 
 public:
-    ModuleShutdownRequestHandler(ModuleAuthenticationData&, Mongo::ModulesCollection&);
+    ModuleShutdownRequestHandler(ModuleAuthenticationData&, ModulesRegistry&);
     ~ModuleShutdownRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string& receivedRequest) override;
+    [[nodiscard]] Communication::Message<WatchdogModule::Operation> createResponse(std::string_view receivedRequest) override;
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 } // namespace Watchdog
\ No newline at end of file
@@ -1,7 +1,12 @@
 #pragma once
+#include "IoContextPool.hpp"
 #include "MongoModulesCollection.hpp"
+#include "MongoRecordsWriter.hpp"
 #include "MongoServicesCollection.hpp"
+#include "ProgramRegistry.hpp"
+#include "StorageExecutor.hpp"
 #include "WatchdogAcceptor.hpp"
+#include "WatchdogConfiguration.hpp"
 #include <boost/asio.hpp>
 #include <thread>
 #include <vector>
@@ -22,19 +27,28 @@ struct AsioThreadsState {
 
 class WatchdogServer {
 private:
-    boost::asio::io_context ioContext;
+    ServerConfiguration configuration;
+    IoContextPool ioContextPool;
     std::vector<std::thread> extraWorkingThreads;
-    std::map<std::thread::id, Mongo::ModulesCollection> modulesCollection;
-    std::map<std::thread::id, Mongo::ServicesCollection> servicesCollection;
+    Mongo::ModulesWriter modulesWriter;
+    Mongo::ServicesWriter servicesWriter;
+    ModulesRegistry modulesRegistry;
+    ServicesRegistry servicesRegistry;
+    StorageExecutor storageExecutor;
     ModulesAcceptor modulesAcceptor;
     ServicesAcceptor servicesAcceptor;
+    AdminAcceptor adminAcceptor;
     StartingState state;
     AsioThreadsState threadsState;
 
     static void onSignal(int signalNum);
+    static void pinToCpu(std::thread& thread, size_t cpuNr);
+    std::optional<ModuleRecord> loadModule(const Types::ModuleIdentifier& moduleIdentifier);
+    std::optional<ServiceRecord> loadService(const Types::ServiceIdentifier& serviceIdentifier);
+    void collectMetrics(Metrics::PrometheusWriter& writer);
 
 public:
-    WatchdogServer();
+    explicit WatchdogServer(const ServerConfiguration& configuration);
     virtual ~WatchdogServer() = default;
 
     bool createWorkingThreads();
@@ -42,6 +56,7 @@ public:
     void setupSignalHandlers();
     bool startAcceptingConnections();
     void setAllConnectedToDisconnectedState();
+    void loadRegistries();
 };
 
 } // namespace Watchdog
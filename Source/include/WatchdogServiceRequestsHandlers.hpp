@@ -1,7 +1,9 @@
 #pragma once
+#include "BufferPool.hpp"
 #include "Communication.hpp"
-#include "MongoServicesCollection.hpp"
+#include "ProgramRegistry.hpp"
 #include "Types.hpp"
+#include <string_view>
 #include "WatchdogService.pb.h"
 #include <boost/asio.hpp>
 
@@ -20,6 +22,8 @@ public:
     explicit ServiceRequestHandlerException(ErrorCode errorCode) { this->errorCode = errorCode; }
     ~ServiceRequestHandlerException() override = default;
 
+    [[nodiscard]] ErrorCode getErrorCode() const { return this->errorCode; }
+
 private:
     ErrorCode errorCode;
 };
@@ -30,17 +34,21 @@ protected:
     Communication::Message<WatchdogService::Operation> responseMessage{};
 
     uint32_t generateNewSequenceCode(uint32_t oldSequenceCode = 0);
+    // Serializes response into pooled body buffer of response message, buffer is moved out with returned response
+    void setResponseBody(const google::protobuf::MessageLite& response);
 
 public:
     explicit ServiceRequestHandler(ServiceAuthenticationData&);
-    virtual ~ServiceRequestHandler() = default;
+    virtual ~ServiceRequestHandler() { Communication::BufferPool::release(std::move(this->responseMessage.body)); }
 
-    [[nodiscard]] virtual Communication::Message<WatchdogService::Operation> createResponse(std::string& receivedRequest) = 0;
+    [[nodiscard]] virtual Communication::Message<WatchdogService::Operation> createResponse(std::string_view receivedRequest) = 0;
+    // Handlers touching database are run on storage executor instead of network thread
+    [[nodiscard]] virtual bool requiresStorage() const { return false; }
 };
 
 class ServiceConnectRequestHandler : public ServiceRequestHandler {
 protected:
-    Mongo::ServicesCollection& servicesCollection;
+    ServicesRegistry& servicesRegistry;
     std::function<void()> timerControl;
     WatchdogService::ConnectRequestData connectRequestData{};
     WatchdogService::ConnectResponseData connectResponseData{};
@@ -48,10 +56,11 @@ protected:
     void processConnectRequest();
 
 public:
-    explicit ServiceConnectRequestHandler(ServiceAuthenticationData&, Mongo::ServicesCollection&, std::function<void()>);
+    explicit ServiceConnectRequestHandler(ServiceAuthenticationData&, ServicesRegistry&, std::function<void()>);
     ~ServiceConnectRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string& receivedRequest);
+    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string_view receivedRequest);
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 class ServicePingRequestHandler : public ServiceRequestHandler {
@@ -64,12 +73,12 @@ public:
     explicit ServicePingRequestHandler(ServiceAuthenticationData&, std::function<void()>);
     ~ServicePingRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string& receivedRequest);
+    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string_view receivedRequest);
 };
 
 class ServiceReconnectRequestHandler : public ServiceRequestHandler {
 protected:
-    Mongo::ServicesCollection& servicesCollection;
+    ServicesRegistry& servicesRegistry;
     std::function<void()> timerControl;
     WatchdogService::ReconnectRequestData reconnectRequestData{};
     WatchdogService::ReconnectResponseData reconnectResponseData{};
@@ -77,22 +86,24 @@ protected:
     void processReconnectRequest();
 
 public:
-    explicit ServiceReconnectRequestHandler(ServiceAuthenticationData&, Mongo::ServicesCollection&, std::function<void()>);
+    explicit ServiceReconnectRequestHandler(ServiceAuthenticationData&, ServicesRegistry&, std::function<void()>);
     ~ServiceReconnectRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string& receivedRequest);
+    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string_view receivedRequest);
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 class ServiceShutdownRequestHandler : public ServiceRequestHandler {
 protected:
-    Mongo::ServicesCollection& servicesCollection;
+    ServicesRegistry& servicesRegistry;
     WatchdogService::ShutdownRequestData shutdownRequestData{};
 
 public:
-    explicit ServiceShutdownRequestHandler(ServiceAuthenticationData&, Mongo::ServicesCollection&);
+    explicit ServiceShutdownRequestHandler(ServiceAuthenticationData&, ServicesRegistry&);
     ~ServiceShutdownRequestHandler() override = default;
 
-    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string& receivedRequest);
+    [[nodiscard]] Communication::Message<WatchdogService::Operation> createResponse(std::string_view receivedRequest);
+    [[nodiscard]] bool requiresStorage() const override { return true; }
 };
 
 } // namespace Watchdog
\ No newline at end of file
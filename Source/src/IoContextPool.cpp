@@ -0,0 +1,51 @@
+#include "IoContextPool.hpp"
+
+namespace Watchdog {
+
+IoContextPool::IoContextPool(size_t shardsCount, ConnectionsDispatch connectionsDispatch) : connectionsDispatch{connectionsDispatch} {
+    shardsCount = std::max<size_t>(shardsCount, 1);
+    // Single shard is shared by all working threads, otherwise each shard is run by exactly one thread
+    int concurrencyHint = shardsCount == 1 ? BOOST_ASIO_CONCURRENCY_HINT_DEFAULT : 1;
+    shards.reserve(shardsCount);
+    workGuards.reserve(shardsCount);
+    for (size_t shardNr = 0; shardNr < shardsCount; shardNr++) {
+        auto& shard = shards.emplace_back(std::make_unique<Shard>(concurrencyHint));
+        // Shard without connections would leave run() immediately
+        workGuards.emplace_back(boost::asio::make_work_guard(shard->ioContext));
+        shard->timerWheel.start();
+    }
+}
+
+IoContextPool::Shard& IoContextPool::selectShard() {
+    Shard* selectedShard{nullptr};
+    if (shards.size() == 1) {
+        selectedShard = shards.front().get();
+    } else if (connectionsDispatch == ConnectionsDispatch::LeastLoad) {
+        auto leastLoaded = std::min_element(std::begin(shards), std::end(shards), [](auto& first, auto& second) {
+            return first->connections.load(std::memory_order_relaxed) < second->connections.load(std::memory_order_relaxed);
+        });
+        selectedShard = leastLoaded->get();
+    } else {
+        selectedShard = shards[nextShard.fetch_add(1, std::memory_order_relaxed) % shards.size()].get();
+    }
+    return *selectedShard;
+}
+
+void IoContextPool::probeLoopLag() {
+    for (auto& shard : shards) {
+        boost::asio::post(shard->ioContext, [&shard = *shard, posted = std::chrono::steady_clock::now()]() {
+            auto lag = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - posted);
+            shard.loopLagNanoseconds.store(lag.count(), std::memory_order_relaxed);
+        });
+    }
+}
+
+void IoContextPool::stop() {
+    workGuards.clear();
+    for (auto& shard : shards) {
+        shard->timerWheel.stop();
+        shard->ioContext.stop();
+    }
+}
+
+} // namespace Watchdog
@@ -0,0 +1,124 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Metrics {
+
+uint64_t HistogramSnapshot::quantile(double quantile) const {
+    uint64_t value{0};
+    if (this->count > 0) {
+        auto rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(this->count)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen{0};
+        for (size_t index = 0; index < this->buckets.size(); index++) {
+            seen += this->buckets[index];
+            if (seen >= rank) {
+                value = Histogram::bucketUpperBound(index);
+                break;
+            }
+        }
+    }
+    return value;
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snapshot{};
+    snapshot.buckets.resize(BucketsCount, 0);
+    for (const auto& shardPointer : shards) {
+        if (const Shard* shard = shardPointer.load(std::memory_order_acquire); shard != nullptr) {
+            for (size_t index = 0; index < BucketsCount; index++) {
+                snapshot.buckets[index] += shard->buckets[index].load(std::memory_order_relaxed);
+            }
+            snapshot.count += shard->count.load(std::memory_order_relaxed);
+            snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+Counter& Registry::counter(std::string name, std::string labels) {
+    std::scoped_lock guard(this->lock);
+    auto& counter = this->counters[Key{std::move(name), std::move(labels)}];
+    if (!counter) {
+        counter = std::make_unique<Counter>();
+    }
+    return *counter;
+}
+
+Histogram& Registry::histogram(std::string name, std::string labels) {
+    std::scoped_lock guard(this->lock);
+    auto& histogram = this->histograms[Key{std::move(name), std::move(labels)}];
+    if (!histogram) {
+        histogram = std::make_unique<Histogram>();
+    }
+    return *histogram;
+}
+
+void Registry::visitCounters(const CounterVisitor& visitor) const {
+    std::scoped_lock guard(this->lock);
+    for (const auto& [key, counter] : this->counters) {
+        visitor(key, *counter);
+    }
+}
+
+void Registry::visitHistograms(const HistogramVisitor& visitor) const {
+    std::scoped_lock guard(this->lock);
+    for (const auto& [key, histogram] : this->histograms) {
+        visitor(key, *histogram);
+    }
+}
+
+void PrometheusWriter::writeType(std::string_view name, std::string_view type) {
+    if (name != this->currentName) {
+        this->currentName = name;
+        this->text.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+    }
+}
+
+void PrometheusWriter::writeSample(std::string_view name, std::string_view labels, std::string_view extraLabel, std::string_view value) {
+    this->text.append(name);
+    if (!labels.empty() || !extraLabel.empty()) {
+        this->text.append("{").append(labels);
+        if (!labels.empty() && !extraLabel.empty()) {
+            this->text.append(",");
+        }
+        this->text.append(extraLabel).append("}");
+    }
+    this->text.append(" ").append(value).append("\n");
+}
+
+void PrometheusWriter::gauge(std::string_view name, std::string_view labels, int64_t value) {
+    this->writeType(name, "gauge");
+    this->writeSample(name, labels, {}, std::to_string(value));
+}
+
+void PrometheusWriter::counter(std::string_view name, std::string_view labels, uint64_t value) {
+    this->writeType(name, "counter");
+    this->writeSample(name, labels, {}, std::to_string(value));
+}
+
+void PrometheusWriter::registry(const Registry& registry) {
+    registry.visitCounters([this](const Registry::Key& key, const Counter& counter) {
+        if (key.name.ends_with("_total")) {
+            this->counter(key.name, key.labels, static_cast<uint64_t>(counter.value()));
+        } else {
+            this->gauge(key.name, key.labels, counter.value());
+        }
+    });
+    registry.visitHistograms([this](const Registry::Key& key, const Histogram& histogram) {
+        constexpr std::array<std::pair<double, std::string_view>, 3> Quantiles{{
+            {0.5, "quantile=\"0.5\""},
+            {0.99, "quantile=\"0.99\""},
+            {0.999, "quantile=\"0.999\""},
+        }};
+        auto snapshot = histogram.snapshot();
+        this->writeType(key.name, "summary");
+        for (const auto& [quantile, quantileLabel] : Quantiles) {
+            this->writeSample(key.name, key.labels, quantileLabel, std::to_string(snapshot.quantile(quantile)));
+        }
+        this->writeSample(key.name + "_sum", key.labels, {}, std::to_string(snapshot.sum));
+        this->writeSample(key.name + "_count", key.labels, {}, std::to_string(snapshot.count));
+    });
+}
+
+} // namespace Metrics
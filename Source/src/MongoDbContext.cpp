@@ -0,0 +1,26 @@
+#include "MongoDbContext.hpp"
+#include "Logging.hpp"
+#include "MongoDbEnvironment.hpp"
+
+namespace Mongo {
+
+DbContext::DbContext(mongocxx::pool::entry clientEntry)
+    : clientEntry{std::move(clientEntry)}, modulesCollection{*this->clientEntry, "Modules"}, servicesCollection{*this->clientEntry,
+                                                                                                                 "Services"} {}
+
+bool DbContext::initialize() {
+    bool isInitialized{true};
+    if (!threadContext) {
+        try {
+            threadContext = std::make_unique<DbContext>(DbEnvironment::getInstance()->getClient());
+        } catch (std::exception& ex) {
+            Log::critical("DbContext::initialize failed to create thread database context: {}", ex.what());
+            isInitialized = false;
+        }
+    }
+    return isInitialized;
+}
+
+void DbContext::release() { threadContext.reset(); }
+
+} // namespace Mongo
@@ -1,6 +1,10 @@
 #include "MongoDbEnvironment.hpp"
 #include "Logging.hpp"
+#include "Metrics.hpp"
+#include <array>
 #include <iostream>
+#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/options/index.hpp>
 
 namespace Mongo {
 
@@ -8,6 +12,25 @@ using bsoncxx::builder::basic::array;
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
 
+namespace {
+
+struct IndexDefinition {
+    const char* collectionName;
+    const char* field;
+    const char* name;
+    bool unique;
+};
+
+// Records are looked up by identifier, connected/disconnected state is switched for all records at once
+constexpr std::array<IndexDefinition, 4> RequiredIndexes{{
+    {"Modules", "ModuleIdentifier", "ModuleIdentifierUnique", true},
+    {"Modules", "ConnectionState", "ConnectionState", false},
+    {"Services", "ServiceIdentifier", "ServiceIdentifierUnique", true},
+    {"Services", "ConnectionState", "ConnectionState", false},
+}};
+
+} // namespace
+
 DbConfigurationReader::DbConfigurationReader(DbConfiguration& dbConfiguration) : dbConfiguration{dbConfiguration} {
     configFile.open(configurationPath);
 }
@@ -65,8 +88,20 @@ bool DbEnvironment::initialize() {
 DbEnvironment::DbEnvironment(std::string address) : mongoInstance{}, clientsPool{mongocxx::uri{address}} {}
 
 mongocxx::pool::entry DbEnvironment::getClient() {
-    auto entry = clientsPool.acquire();
-    return entry;
+    static auto& acquireLatency = Metrics::Registry::get().histogram("watchdog_mongo_pool_acquire_duration_nanoseconds");
+    mongocxx::pool::entry entry{nullptr};
+    {
+        // Acquire blocks while all clients of pool are in use
+        Metrics::ScopedTimer timer{acquireLatency};
+        entry = clientsPool.acquire();
+    }
+    this->clientsInUse.fetch_add(1, std::memory_order_relaxed);
+    // Client goes back to pool through original deleter, in use count is released together with it
+    auto returnToPool = entry.get_deleter();
+    return mongocxx::pool::entry{entry.release(), [this, returnToPool](mongocxx::client* client) {
+                                     returnToPool(client);
+                                     this->clientsInUse.fetch_sub(1, std::memory_order_relaxed);
+                                 }};
 }
 
 bool DbEnvironment::isConnected() {
@@ -87,4 +122,49 @@ bool DbEnvironment::isConnected() {
     return mongoDbConnected;
 }
 
+bool DbEnvironment::ensureIndexes() {
+    bool uniqueIndexesPresent{true};
+    auto clientEntry = DbEnvironment::getInstance()->getClient();
+    auto db = (*clientEntry)["ProcessManager"];
+    for (const auto& index : RequiredIndexes) {
+        auto collection = db[index.collectionName];
+        mongocxx::options::index indexOptions{};
+        indexOptions.name(index.name);
+        indexOptions.unique(index.unique);
+        try {
+            // Creating index which already exists with same definition does nothing
+            collection.create_index(make_document(kvp(index.field, 1)), indexOptions);
+        } catch (mongocxx::operation_exception& ex) {
+            Log::error("DbEnvironment::ensureIndexes failed to create index {}: {}", index.name, ex.what());
+        }
+        if (!DbEnvironment::hasIndex(collection, index.name)) {
+            if (index.unique) {
+                // Without it concurrent registrations may store the same identifier twice
+                Log::critical("DbEnvironment::ensureIndexes missing unique index {} in collection {}", index.name, index.collectionName);
+                uniqueIndexesPresent = false;
+            } else {
+                Log::error("DbEnvironment::ensureIndexes missing index {} in collection {}, lookups will scan whole collection",
+                           index.name, index.collectionName);
+            }
+        }
+    }
+    return uniqueIndexesPresent;
+}
+
+bool DbEnvironment::hasIndex(mongocxx::collection& collection, std::string_view indexName) {
+    bool indexFound{false};
+    try {
+        auto cursor = collection.indexes().list();
+        for (auto index : cursor) {
+            bsoncxx::document::view view{index};
+            if (view["name"] && view["name"].get_utf8().value.to_string() == indexName) {
+                indexFound = true;
+            }
+        }
+    } catch (mongocxx::operation_exception& ex) {
+        Log::error("DbEnvironment::hasIndex failed to list indexes: {}", ex.what());
+    }
+    return indexFound;
+}
+
 } // namespace Mongo
\ No newline at end of file
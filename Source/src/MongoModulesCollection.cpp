@@ -1,9 +1,16 @@
 #include "MongoModulesCollection.hpp"
 #include "Logging.hpp"
+#include "Metrics.hpp"
 #include "MongoDbEnvironment.hpp"
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/stream/array.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/model/update_one.hpp>
+#include <mongocxx/options/bulk_write.hpp>
+#include <mongocxx/options/insert.hpp>
 
 using bsoncxx::builder::stream::close_array;
 using bsoncxx::builder::stream::close_document;
@@ -14,25 +21,57 @@ using bsoncxx::builder::stream::open_document;
 
 namespace Mongo {
 
+namespace {
+
+Metrics::Histogram& callLatency(const char* method) {
+    return Metrics::Registry::get().histogram("watchdog_mongo_call_duration_nanoseconds",
+                                              "collection=\"Modules\",method=\"" + std::string{method} + "\"");
+}
+
+} // namespace
+
 ModulesCollection::ModulesCollection(mongocxx::client& client, std::string collectionName)
     : modulesCollection{client["ProcessManager"][collectionName]} {}
 
 bool ModulesCollection::insertOne(ModuleRecord&& record) {
+    static auto& latency = callLatency("insertOne");
+    Metrics::ScopedTimer timer{latency};
     bool moduleInserted{true};
-    auto builder = document{};
-    bsoncxx::document::value newModule = builder << "ModuleIdentifier" << record.identifier // To prevent line move by clang
-                                                 << "IpAddress" << record.ipAddress         // To prevent line move by clang
-                                                 << "ConnectionState" << static_cast<int32_t>(record.connectionState) // Prevent move
-                                                 << "Port" << record.port // To prevent line move by clang
-                                                 << finalize;
-    auto result = modulesCollection.insert_one(std::move(newModule));
+    auto result = modulesCollection.insert_one(ModulesCollection::moduleRecordToDocument(record));
     if (!result) {
         moduleInserted = false;
     }
     return moduleInserted;
 }
 
+bool ModulesCollection::insertMany(std::vector<ModuleRecord>&& records) {
+    static auto& latency = callLatency("insertMany");
+    Metrics::ScopedTimer timer{latency};
+    bool modulesInserted{true};
+    if (!records.empty()) {
+        std::vector<bsoncxx::document::value> newModules{};
+        newModules.reserve(records.size());
+        for (const auto& record : records) {
+            newModules.push_back(ModulesCollection::moduleRecordToDocument(record));
+        }
+        // Unordered insert does not stop on first duplicate, remaining records are still inserted
+        mongocxx::options::insert insertOptions{};
+        insertOptions.ordered(false);
+        try {
+            if (!modulesCollection.insert_many(newModules, insertOptions)) {
+                modulesInserted = false;
+            }
+        } catch (mongocxx::bulk_write_exception& ex) {
+            Log::error("ModulesCollection::insertMany bulk write failed: {}", ex.what());
+            modulesInserted = false;
+        }
+    }
+    return modulesInserted;
+}
+
 bool ModulesCollection::findOne(Types::ModuleIdentifier& moduleIdentifier) {
+    static auto& latency = callLatency("findOne");
+    Metrics::ScopedTimer timer{latency};
     bool found{true};
     auto builder = document{};
     bsoncxx::document::value entry = builder << "ModuleIdentifier" << moduleIdentifier << finalize;
@@ -45,12 +84,16 @@ bool ModulesCollection::findOne(Types::ModuleIdentifier& moduleIdentifier) {
 }
 
 void ModulesCollection::deleteOne(Types::ModuleIdentifier& moduleIdentifier) {
+    static auto& latency = callLatency("deleteOne");
+    Metrics::ScopedTimer timer{latency};
     auto builder = document{};
     bsoncxx::document::value entry = builder << "ModuleIdentifier" << moduleIdentifier << finalize;
     modulesCollection.delete_one(std::move(entry));
 }
 
 bool ModulesCollection::setAllAsRegistered() {
+    static auto& latency = callLatency("setAllAsRegistered");
+    Metrics::ScopedTimer timer{latency};
     bool allSetAsRegistered{false};
     auto result = modulesCollection.update_many(document{}                                          // To prevent line move by clang
                                                     << "ModuleIdentifier" << open_document          // To prevent line move by clang
@@ -67,6 +110,8 @@ bool ModulesCollection::setAllAsRegistered() {
 }
 
 bool ModulesCollection::setDisconnected(Types::ModuleIdentifier& moduleIdentifier) {
+    static auto& latency = callLatency("setDisconnected");
+    Metrics::ScopedTimer timer{latency};
     bool recordUpdated{false};
     auto result =
         modulesCollection.update_one(document{}                                    // To prevent line move by clang
@@ -83,7 +128,14 @@ bool ModulesCollection::setDisconnected(Types::ModuleIdentifier& moduleIdentifie
     return recordUpdated;
 }
 
-std::optional<ModuleRecord> ModulesCollection::viewToModuleRecord(bsoncxx::document::view& view) {
+bsoncxx::document::value ModulesCollection::moduleRecordToDocument(const ModuleRecord& record) {
+    return document{} << "ModuleIdentifier" << record.identifier                           // To prevent line move by clang
+                      << "IpAddress" << record.ipAddress                                   // To prevent line move by clang
+                      << "ConnectionState" << static_cast<int32_t>(record.connectionState) // Prevent move
+                      << "Port" << record.port << finalize;
+}
+
+std::optional<ModuleRecord> ModulesCollection::viewToModuleRecord(const bsoncxx::document::view& view) {
     std::optional<ModuleRecord> moduleRecord{std::nullopt};
     auto modIdentifier = view["ModuleIdentifier"];
     auto connectionState = view["ConnectionState"];
@@ -109,7 +161,19 @@ std::optional<ModuleRecord> ModulesCollection::viewToModuleRecord(bsoncxx::docum
     return moduleRecord;
 }
 
+bsoncxx::document::value ModulesCollection::identifiersFilter(std::span<const Types::ModuleIdentifier> moduleIdentifiers) {
+    bsoncxx::builder::basic::array identifiers{};
+    for (const auto& moduleIdentifier : moduleIdentifiers) {
+        identifiers.append(moduleIdentifier);
+    }
+    return document{} << "ModuleIdentifier" << open_document                  // To prevent line move by clang
+                      << "$in" << bsoncxx::types::b_array{identifiers.view()} // To prevent line move by clang
+                      << close_document << finalize;
+}
+
 std::optional<ModuleRecord> ModulesCollection::getModule(Types::ModuleIdentifier& moduleIdentifier) {
+    static auto& latency = callLatency("getModule");
+    Metrics::ScopedTimer timer{latency};
     std::optional<ModuleRecord> moduleRecord{std::nullopt};
     auto builder = document{};
     bsoncxx::document::value entry = builder << "ModuleIdentifier" << moduleIdentifier << finalize;
@@ -122,9 +186,15 @@ std::optional<ModuleRecord> ModulesCollection::getModule(Types::ModuleIdentifier
     return moduleRecord;
 }
 
-void ModulesCollection::drop() { modulesCollection.drop(); }
+void ModulesCollection::drop() {
+    static auto& latency = callLatency("drop");
+    Metrics::ScopedTimer timer{latency};
+    modulesCollection.drop();
+}
 
 std::optional<ModuleRecord> ModulesCollection::getModule(const Types::ModuleIdentifier& moduleIdentifier) {
+    static auto& latency = callLatency("getModule");
+    Metrics::ScopedTimer timer{latency};
     std::optional<ModuleRecord> moduleRecord{std::nullopt};
     auto builder = document{};
     bsoncxx::document::value entry = builder << "ModuleIdentifier" << moduleIdentifier << finalize;
@@ -137,7 +207,26 @@ std::optional<ModuleRecord> ModulesCollection::getModule(const Types::ModuleIden
     return moduleRecord;
 }
 
+std::vector<ModuleRecord> ModulesCollection::getModules(std::span<const Types::ModuleIdentifier> moduleIdentifiers) {
+    static auto& latency = callLatency("getModules");
+    Metrics::ScopedTimer timer{latency};
+    std::vector<ModuleRecord> records{};
+    if (!moduleIdentifiers.empty()) {
+        records.reserve(moduleIdentifiers.size());
+        auto cursor = modulesCollection.find(this->identifiersFilter(moduleIdentifiers));
+        for (auto document : cursor) {
+            bsoncxx::document::view view{document};
+            if (auto moduleRecord = this->viewToModuleRecord(view); moduleRecord.has_value()) {
+                records.push_back(std::move(*moduleRecord));
+            }
+        }
+    }
+    return records;
+}
+
 std::vector<ModuleRecord> ModulesCollection::getAllModules() {
+    static auto& latency = callLatency("getAllModules");
+    Metrics::ScopedTimer timer{latency};
     std::vector<ModuleRecord> records{};
     auto cursor = modulesCollection.find({});
     for (auto document : cursor) {
@@ -149,23 +238,74 @@ std::vector<ModuleRecord> ModulesCollection::getAllModules() {
     return records;
 }
 
-bool ModulesCollection::updateModule(ModuleRecord&& record) {
+bool ModulesCollection::updateModule(ModuleRecord&& record, Types::RecordField fields) {
+    static auto& latency = callLatency("updateModule");
+    Metrics::ScopedTimer timer{latency};
     bool recordUpdated{false};
-    auto result =
-        modulesCollection.update_one(document{}                                     // To prevent line move by clang
-                                         << "ModuleIdentifier" << record.identifier // To prevent line move by clang
-                                         << finalize,                               // To prevent line move by clang
-                                     document{}                                     // To prevent line move by clang
-                                         << "$set" << open_document                 // To prevent line move by clang
-                                         << "ConnectionState" << static_cast<int32_t>(record.connectionState) // Prevent
-                                         << "IpAddress" << record.ipAddress << "Port" << record.port << close_document << finalize);
-    if (result) {
+    if (fields == Types::RecordField::None) {
         recordUpdated = true;
+    } else {
+        this->updateBuilder.build(record, fields);
+        if (modulesCollection.update_one(this->updateBuilder.filter(), this->updateBuilder.update())) {
+            recordUpdated = true;
+        }
     }
     return recordUpdated;
 }
 
+bool ModulesCollection::updateMany(std::span<const ModuleRecord> records) {
+    std::vector<RecordUpdate<ModuleRecord>> updates{};
+    updates.reserve(records.size());
+    for (const auto& record : records) {
+        updates.push_back(RecordUpdate<ModuleRecord>{record, Types::RecordField::All});
+    }
+    return this->updateMany(updates);
+}
+
+bool ModulesCollection::updateMany(std::span<const RecordUpdate<ModuleRecord>> updates) {
+    static auto& latency = callLatency("updateMany");
+    Metrics::ScopedTimer timer{latency};
+    bool recordsUpdated{true};
+    mongocxx::options::bulk_write bulkOptions{};
+    bulkOptions.ordered(true);
+    auto bulk = modulesCollection.create_bulk_write(bulkOptions);
+    bool bulkEmpty{true};
+    for (const auto& update : updates) {
+        if (update.fields != Types::RecordField::None) {
+            // Bulk keeps its own copy of appended documents, so builder may be reused for next record
+            this->updateBuilder.build(update.record, update.fields);
+            bulk.append(mongocxx::model::update_one{this->updateBuilder.filter(), this->updateBuilder.update()});
+            bulkEmpty = false;
+        }
+    }
+    if (!bulkEmpty) {
+        try {
+            if (!bulk.execute()) {
+                recordsUpdated = false;
+            }
+        } catch (mongocxx::bulk_write_exception& ex) {
+            Log::error("ModulesCollection::updateMany bulk write failed: {}", ex.what());
+            recordsUpdated = false;
+        }
+    }
+    return recordsUpdated;
+}
+
+bool ModulesCollection::deleteMany(std::span<const Types::ModuleIdentifier> moduleIdentifiers) {
+    static auto& latency = callLatency("deleteMany");
+    Metrics::ScopedTimer timer{latency};
+    bool recordsDeleted{true};
+    if (!moduleIdentifiers.empty()) {
+        if (!modulesCollection.delete_many(this->identifiersFilter(moduleIdentifiers))) {
+            recordsDeleted = false;
+        }
+    }
+    return recordsDeleted;
+}
+
 bool ModulesCollection::markAllConnectedAsDisconnected() {
+    static auto& latency = callLatency("markAllConnectedAsDisconnected");
+    Metrics::ScopedTimer timer{latency};
     bool recordUpdated{false};
     auto result =
         modulesCollection.update_many(document{} // To prevent line move by clang
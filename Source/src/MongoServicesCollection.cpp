@@ -1,9 +1,16 @@
 #include "MongoServicesCollection.hpp"
 #include "Logging.hpp"
+#include "Metrics.hpp"
 #include "MongoDbEnvironment.hpp"
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/stream/array.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/model/update_one.hpp>
+#include <mongocxx/options/bulk_write.hpp>
+#include <mongocxx/options/insert.hpp>
 
 using bsoncxx::builder::stream::close_array;
 using bsoncxx::builder::stream::close_document;
@@ -14,10 +21,23 @@ using bsoncxx::builder::stream::open_document;
 
 namespace Mongo {
 
+namespace {
+
+Metrics::Histogram& callLatency(const char* method) {
+    return Metrics::Registry::get().histogram("watchdog_mongo_call_duration_nanoseconds",
+                                              "collection=\"Services\",method=\"" + std::string{method} + "\"");
+}
+
+} // namespace
+
 ServicesCollection::ServicesCollection(mongocxx::client& client, std::string collectionName)
     : servicesCollection{client["ProcessManager"][collectionName]} {}
 
-void ServicesCollection::drop() { servicesCollection.drop(); }
+void ServicesCollection::drop() {
+    static auto& latency = callLatency("drop");
+    Metrics::ScopedTimer timer{latency};
+    servicesCollection.drop();
+}
 
 std::optional<ServiceRecord> ServicesCollection::viewToServiceRecord(bsoncxx::document::view& view) {
     std::optional<ServiceRecord> serviceRecord{std::nullopt};
@@ -44,7 +64,19 @@ std::optional<ServiceRecord> ServicesCollection::viewToServiceRecord(bsoncxx::do
     return serviceRecord;
 }
 
+bsoncxx::document::value ServicesCollection::identifiersFilter(std::span<const Types::ServiceIdentifier> serviceIdentifiers) {
+    bsoncxx::builder::basic::array identifiers{};
+    for (const auto& serviceIdentifier : serviceIdentifiers) {
+        identifiers.append(serviceIdentifier);
+    }
+    return document{} << "ServiceIdentifier" << open_document                 // To prevent line move by clang
+                      << "$in" << bsoncxx::types::b_array{identifiers.view()} // To prevent line move by clang
+                      << close_document << finalize;
+}
+
 bool ServicesCollection::insertOne(ServiceRecord&& record) {
+    static auto& latency = callLatency("insertOne");
+    Metrics::ScopedTimer timer{latency};
     bool serviceInserted{true};
     auto builder = document{};
     bsoncxx::document::value newService = builder << "ServiceIdentifier" << record.identifier // To prevent line move by clang
@@ -59,7 +91,38 @@ bool ServicesCollection::insertOne(ServiceRecord&& record) {
     return serviceInserted;
 }
 
+bool ServicesCollection::insertMany(std::vector<ServiceRecord>&& records) {
+    static auto& latency = callLatency("insertMany");
+    Metrics::ScopedTimer timer{latency};
+    bool servicesInserted{true};
+    if (!records.empty()) {
+        std::vector<bsoncxx::document::value> newServices{};
+        newServices.reserve(records.size());
+        for (auto& record : records) {
+            newServices.push_back(document{}                                                           // To prevent line move by clang
+                                  << "ServiceIdentifier" << record.identifier                          // To prevent line move by clang
+                                  << "IpAddress" << record.ipAddress                                   // To prevent line move by clang
+                                  << "ConnectionState" << static_cast<int32_t>(record.connectionState) // Prevent move
+                                  << "Port" << record.port << finalize);
+        }
+        // Unordered insert does not stop on first duplicate, remaining records are still inserted
+        mongocxx::options::insert insertOptions{};
+        insertOptions.ordered(false);
+        try {
+            if (!servicesCollection.insert_many(newServices, insertOptions)) {
+                servicesInserted = false;
+            }
+        } catch (mongocxx::bulk_write_exception& ex) {
+            Log::error("ServicesCollection::insertMany bulk write failed: {}", ex.what());
+            servicesInserted = false;
+        }
+    }
+    return servicesInserted;
+}
+
 std::optional<ServiceRecord> ServicesCollection::getService(const Types::ServiceIdentifier& serviceIdentifier) {
+    static auto& latency = callLatency("getService");
+    Metrics::ScopedTimer timer{latency};
     std::optional<ServiceRecord> serviceRecord{std::nullopt};
     auto builder = document{};
     bsoncxx::document::value entry = builder << "ServiceIdentifier" << serviceIdentifier << finalize;
@@ -71,22 +134,105 @@ std::optional<ServiceRecord> ServicesCollection::getService(const Types::Service
     return serviceRecord;
 }
 
-bool ServicesCollection::updateService(ServiceRecord&& record) {
+std::vector<ServiceRecord> ServicesCollection::getServices(std::span<const Types::ServiceIdentifier> serviceIdentifiers) {
+    static auto& latency = callLatency("getServices");
+    Metrics::ScopedTimer timer{latency};
+    std::vector<ServiceRecord> records{};
+    if (!serviceIdentifiers.empty()) {
+        records.reserve(serviceIdentifiers.size());
+        auto cursor = servicesCollection.find(this->identifiersFilter(serviceIdentifiers));
+        for (auto document : cursor) {
+            bsoncxx::document::view view{document};
+            if (auto serviceRecord = this->viewToServiceRecord(view); serviceRecord.has_value()) {
+                records.push_back(std::move(*serviceRecord));
+            }
+        }
+    }
+    return records;
+}
+
+std::vector<ServiceRecord> ServicesCollection::getAllServices() {
+    static auto& latency = callLatency("getAllServices");
+    Metrics::ScopedTimer timer{latency};
+    std::vector<ServiceRecord> records{};
+    auto cursor = servicesCollection.find({});
+    for (auto document : cursor) {
+        bsoncxx::document::view view{document};
+        if (auto serviceRecord = this->viewToServiceRecord(view); serviceRecord.has_value()) {
+            records.push_back(std::move(*serviceRecord));
+        }
+    }
+    return records;
+}
+
+bool ServicesCollection::updateService(ServiceRecord&& record, Types::RecordField fields) {
+    static auto& latency = callLatency("updateService");
+    Metrics::ScopedTimer timer{latency};
     bool recordUpdated{false};
-    auto result = servicesCollection.update_one(document{}                                      // To prevent line move by clang
-                                                    << "ServiceIdentifier" << record.identifier // To prevent line move by clang
-                                                    << finalize,                                // To prevent line move by clang
-                                                document{}                                      // To prevent line move by clang
-                                                    << "$set" << open_document                  // To prevent line move by clang
-                                                    << "ConnectionState" << static_cast<int32_t>(record.connectionState) // Prevent
-                                                    << "IpAddress" << record.ipAddress << close_document << finalize);
-    if (result) {
+    if (fields == Types::RecordField::None) {
         recordUpdated = true;
+    } else {
+        this->updateBuilder.build(record, fields);
+        if (servicesCollection.update_one(this->updateBuilder.filter(), this->updateBuilder.update())) {
+            recordUpdated = true;
+        }
     }
     return recordUpdated;
 }
 
+bool ServicesCollection::updateMany(std::span<const ServiceRecord> records) {
+    std::vector<RecordUpdate<ServiceRecord>> updates{};
+    updates.reserve(records.size());
+    for (const auto& record : records) {
+        updates.push_back(RecordUpdate<ServiceRecord>{record, Types::RecordField::All});
+    }
+    return this->updateMany(updates);
+}
+
+bool ServicesCollection::updateMany(std::span<const RecordUpdate<ServiceRecord>> updates) {
+    static auto& latency = callLatency("updateMany");
+    Metrics::ScopedTimer timer{latency};
+    bool recordsUpdated{true};
+    mongocxx::options::bulk_write bulkOptions{};
+    bulkOptions.ordered(true);
+    auto bulk = servicesCollection.create_bulk_write(bulkOptions);
+    bool bulkEmpty{true};
+    for (const auto& update : updates) {
+        if (update.fields != Types::RecordField::None) {
+            // Bulk keeps its own copy of appended documents, so builder may be reused for next record
+            this->updateBuilder.build(update.record, update.fields);
+            bulk.append(mongocxx::model::update_one{this->updateBuilder.filter(), this->updateBuilder.update()});
+            bulkEmpty = false;
+        }
+    }
+    if (!bulkEmpty) {
+        try {
+            if (!bulk.execute()) {
+                recordsUpdated = false;
+            }
+        } catch (mongocxx::bulk_write_exception& ex) {
+            Log::error("ServicesCollection::updateMany bulk write failed: {}", ex.what());
+            recordsUpdated = false;
+        }
+    }
+    return recordsUpdated;
+}
+
+bool ServicesCollection::deleteMany(std::span<const Types::ServiceIdentifier> serviceIdentifiers) {
+    static auto& latency = callLatency("deleteMany");
+    Metrics::ScopedTimer timer{latency};
+    bool recordsDeleted{true};
+    if (!serviceIdentifiers.empty()) {
+        if (!servicesCollection.delete_many(this->identifiersFilter(serviceIdentifiers))) {
+            recordsDeleted = false;
+        }
+    }
+    return recordsDeleted;
+}
+
 bool ServicesCollection::markAllConnectedAsDisconnected() {
+    static auto& latency = callLatency("markAllConnectedAsDisconnected");
+    Metrics::ScopedTimer timer{latency};
     bool recordUpdated{false};
     auto result =
         servicesCollection.update_many(document{} // To prevent line move by clang
@@ -0,0 +1,34 @@
+#include "StorageExecutor.hpp"
+#include "Logging.hpp"
+#include "MongoDbContext.hpp"
+
+namespace Watchdog {
+
+StorageExecutor::StorageExecutor(size_t threadsCount) : workGuard{boost::asio::make_work_guard(ioContext)} {
+    threadsCount = std::max<size_t>(threadsCount, 1);
+    storageThreads.reserve(threadsCount);
+    for (size_t threadNr = 0; threadNr < threadsCount; threadNr++) {
+        storageThreads.emplace_back([this]() {
+            // Database context has to exist before first storage work runs on this thread
+            if (!Mongo::DbContext::initialize()) {
+                Log::critical("StorageExecutor::StorageExecutor storage thread runs without mongodb context");
+            }
+            this->ioContext.run();
+            Mongo::DbContext::release();
+        });
+    }
+}
+
+StorageExecutor::~StorageExecutor() { this->stop(); }
+
+void StorageExecutor::stop() {
+    workGuard.reset();
+    ioContext.stop();
+    for (auto& storageThread : storageThreads) {
+        if (storageThread.joinable()) {
+            storageThread.join();
+        }
+    }
+}
+
+} // namespace Watchdog
@@ -0,0 +1,121 @@
+#include "TimerWheel.hpp"
+#include "Logging.hpp"
+
+namespace Connection {
+
+TimerWheel::TimerWheel(boost::asio::io_context& ioContext, std::chrono::milliseconds tickDuration, size_t slotsCount)
+    : tickDuration{tickDuration}, slots(std::max<size_t>(slotsCount, 1)), tickTimer{ioContext} {
+    for (auto& sentinel : slots) {
+        sentinel.previous = &sentinel;
+        sentinel.next = &sentinel;
+    }
+}
+
+void TimerWheel::start() {
+    std::scoped_lock guard(this->lock);
+    if (!this->running) {
+        this->running = true;
+        this->startTime = std::chrono::steady_clock::now();
+        this->currentTick = 0;
+        this->waitForTick();
+    }
+}
+
+void TimerWheel::stop() {
+    std::scoped_lock guard(this->lock);
+    this->running = false;
+    this->tickTimer.cancel();
+}
+
+void TimerWheel::waitForTick() {
+    this->tickTimer.expires_at(this->startTime + this->tickDuration * (this->currentTick + 1));
+    this->tickTimer.async_wait([this](const boost::system::error_code& error) { this->onTick(error); });
+}
+
+void TimerWheel::link(Timer& timer) {
+    auto& sentinel = slots[timer.expirationTick % slots.size()];
+    timer.previous = sentinel.previous;
+    timer.next = &sentinel;
+    sentinel.previous->next = &timer;
+    sentinel.previous = &timer;
+    this->scheduledTimers++;
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    timer.previous->next = timer.next;
+    timer.next->previous = timer.previous;
+    timer.previous = nullptr;
+    timer.next = nullptr;
+    this->scheduledTimers--;
+}
+
+uint64_t TimerWheel::expirationTickAfter(std::chrono::milliseconds timeout) const {
+    // Deadline is measured from wheel start and rounded up to whole tick, it does not move when tick handler lags behind clock
+    auto elapsed = this->running ? std::chrono::steady_clock::now() - this->startTime : std::chrono::steady_clock::duration::zero();
+    auto deadline = elapsed + timeout + this->tickDuration - std::chrono::steady_clock::duration{1};
+    auto expirationTick = static_cast<uint64_t>(deadline / this->tickDuration);
+    // Slot of current tick was already swept
+    return std::max(expirationTick, this->currentTick + 1);
+}
+
+void TimerWheel::schedule(Timer& timer, std::chrono::milliseconds timeout, std::function<void()> onExpiration) {
+    std::scoped_lock guard(this->lock);
+    if (timer.isScheduled()) {
+        this->unlink(timer);
+    }
+    timer.onExpiration = std::move(onExpiration);
+    timer.expirationTick = this->expirationTickAfter(timeout);
+    this->link(timer);
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    std::scoped_lock guard(this->lock);
+    if (timer.isScheduled()) {
+        this->unlink(timer);
+    }
+}
+
+size_t TimerWheel::size() const {
+    std::scoped_lock guard(this->lock);
+    return this->scheduledTimers;
+}
+
+void TimerWheel::onTick(const boost::system::error_code& error) {
+    if (error == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    std::vector<std::function<void()>> expiredHandlers{};
+    {
+        std::scoped_lock guard(this->lock);
+        if (!this->running) {
+            return;
+        }
+        // Catch up ticks missed while io_context was busy
+        auto elapsedTicks = static_cast<uint64_t>((std::chrono::steady_clock::now() - this->startTime) / this->tickDuration);
+        while (this->currentTick < elapsedTicks) {
+            this->currentTick++;
+            auto& sentinel = slots[this->currentTick % slots.size()];
+            for (Timer* timer = sentinel.next; timer != &sentinel;) {
+                Timer* nextTimer = timer->next;
+                // Timers scheduled more than one wheel turn ahead stay in slot
+                if (timer->expirationTick <= this->currentTick) {
+                    this->unlink(*timer);
+                    expiredHandlers.push_back(std::move(timer->onExpiration));
+                    timer->onExpiration = nullptr;
+                }
+                timer = nextTimer;
+            }
+        }
+        this->waitForTick();
+    }
+
+    // Handlers are called without lock, they are allowed to schedule timers again
+    for (auto& handler : expiredHandlers) {
+        if (handler) {
+            handler();
+        }
+    }
+}
+
+} // namespace Connection
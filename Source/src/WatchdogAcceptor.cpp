@@ -2,24 +2,30 @@
 #include "Connection.hpp"
 #include "Logging.hpp"
 #include "WatchdogConnection.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/bind/bind.hpp>
+#include <algorithm>
 #include <memory>
 
 namespace Watchdog {
 
-ModulesAcceptor::ModulesAcceptor(boost::asio::io_context& ioContext, std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection,
-                                 std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection)
-    : ioContext{ioContext}, modulesCollection{modulesCollection}, servicesCollection{servicesCollection} {
+ModulesAcceptor::ModulesAcceptor(IoContextPool& ioContextPool, ModulesRegistry& modulesRegistry, ServicesRegistry& servicesRegistry,
+                                 StorageExecutor& storageExecutor)
+    : ioContextPool{ioContextPool}, modulesRegistry{modulesRegistry}, servicesRegistry{servicesRegistry}, storageExecutor{storageExecutor} {
     try {
         boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::tcp::v4(), 1234};
-        acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(ioContext, endpoint);
+        acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(ioContextPool.getShard(0).ioContext, endpoint);
     } catch (boost::system::system_error& err) {
-        Log::critical(std::string("Failed during creating acceptor: " + std::string(err.what())));
+        Log::critical("Failed during creating acceptor: {}", err.what());
     }
 }
 
 void ModulesAcceptor::startAcceptingConnections() {
     if (acceptor) {
-        auto newSession = std::make_shared<ModuleConnection>(ioContext, modulesCollection, servicesCollection);
+        auto newSession = ioContextPool.makeConnection<ModuleConnection>(modulesRegistry, servicesRegistry, storageExecutor);
         acceptor->async_accept(newSession->getSocket(),
                                boost::bind(&ModulesAcceptor::postAccept, this, newSession, boost::asio::placeholders::error));
     } else {
@@ -29,7 +35,7 @@ void ModulesAcceptor::startAcceptingConnections() {
 
 void ModulesAcceptor::postAccept(std::shared_ptr<ModuleConnection> newSession, const boost::system::error_code& error) {
     if (error) {
-        Log::critical(std::string("Failure during accepting connection"));
+        Log::critical("Failure during accepting connection");
         return;
     }
     Log::info("Module accepted");
@@ -38,21 +44,20 @@ void ModulesAcceptor::postAccept(std::shared_ptr<ModuleConnection> newSession, c
     this->startAcceptingConnections();
 }
 
-ServicesAcceptor::ServicesAcceptor(boost::asio::io_context& ioContext,
-                                   std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection,
-                                   std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection)
-    : ioContext{ioContext}, servicesCollection{servicesCollection}, modulesCollection{modulesCollection} {
+ServicesAcceptor::ServicesAcceptor(IoContextPool& ioContextPool, ModulesRegistry& modulesRegistry, ServicesRegistry& servicesRegistry,
+                                   StorageExecutor& storageExecutor)
+    : ioContextPool{ioContextPool}, modulesRegistry{modulesRegistry}, servicesRegistry{servicesRegistry}, storageExecutor{storageExecutor} {
     try {
         boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::tcp::v4(), 1235};
-        acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(ioContext, endpoint);
+        acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(ioContextPool.getShard(0).ioContext, endpoint);
     } catch (boost::system::system_error& err) {
-        Log::critical(std::string("Failed during creating acceptor: " + std::string(err.what())));
+        Log::critical("Failed during creating acceptor: {}", err.what());
     }
 }
 
 void ServicesAcceptor::startAcceptingServices() {
     if (acceptor) {
-        auto newSession = std::make_shared<ServiceConnection>(ioContext, modulesCollection, servicesCollection);
+        auto newSession = ioContextPool.makeConnection<ServiceConnection>(modulesRegistry, servicesRegistry, storageExecutor);
         acceptor->async_accept(newSession->getSocket(),
                                boost::bind(&ServicesAcceptor::serviceAccepted, this, newSession, boost::asio::placeholders::error));
     } else {
@@ -62,7 +67,7 @@ void ServicesAcceptor::startAcceptingServices() {
 
 void ServicesAcceptor::serviceAccepted(std::shared_ptr<ServiceConnection> newServiceSession, const boost::system::error_code& error) {
     if (error) {
-        Log::critical(std::string("Failure during accepting connection"));
+        Log::critical("Failure during accepting connection");
         return;
     }
     Log::info("Service accepted");
@@ -70,4 +75,83 @@ void ServicesAcceptor::serviceAccepted(std::shared_ptr<ServiceConnection> newSer
     newServiceSession->startReading();
 }
 
+AdminAcceptor::AdminAcceptor(Collector collector) : collector{std::move(collector)} {}
+
+AdminAcceptor::~AdminAcceptor() { this->stop(); }
+
+bool AdminAcceptor::start(uint16_t port) {
+    bool started{true};
+    try {
+        boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::address_v4::loopback(), port};
+        acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(ioContext, endpoint);
+        boost::asio::co_spawn(ioContext, this->acceptLoop(), boost::asio::detached);
+        thread = std::thread([this]() { this->ioContext.run(); });
+        Log::info("AdminAcceptor::start serving metrics on 127.0.0.1:{}", port);
+    } catch (boost::system::system_error& err) {
+        Log::critical("Failed during creating admin acceptor: {}", err.what());
+        started = false;
+    }
+    return started;
+}
+
+void AdminAcceptor::stop() {
+    ioContext.stop();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool AdminAcceptor::isTransientAcceptError(const boost::system::error_code& error) {
+    // Connection dropped before it was accepted or process ran out of descriptors or memory for while
+    return error == boost::asio::error::connection_aborted || error == boost::asio::error::connection_reset ||
+           error == boost::asio::error::interrupted || error == boost::asio::error::try_again ||
+           error == boost::asio::error::no_descriptors || error == boost::asio::error::no_buffer_space ||
+           error == boost::asio::error::no_memory || error == boost::system::errc::too_many_files_open_in_system;
+}
+
+boost::asio::awaitable<void> AdminAcceptor::acceptLoop() {
+    boost::asio::steady_timer retryTimer{ioContext};
+    auto retryDelay = InitialAcceptRetryDelay;
+    while (acceptor->is_open()) {
+        boost::system::error_code error{};
+        auto socket = co_await acceptor->async_accept(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        if (!error) {
+            retryDelay = InitialAcceptRetryDelay;
+            boost::asio::co_spawn(ioContext, this->serve(std::move(socket)), boost::asio::detached);
+        } else if (isTransientAcceptError(error)) {
+            // Accepting again right away would spin on the same error, give process time to recover
+            Log::error("AdminAcceptor::acceptLoop: {}, retrying in {}ms", error.message(), retryDelay.count());
+            retryTimer.expires_after(retryDelay);
+            co_await retryTimer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            retryDelay = std::min(retryDelay * 2, MaxAcceptRetryDelay);
+        } else {
+            if (error != boost::asio::error::operation_aborted) {
+                Log::critical("AdminAcceptor::acceptLoop: {}, metrics are no longer served", error.message());
+            }
+            break;
+        }
+    }
+}
+
+boost::asio::awaitable<void> AdminAcceptor::serve(boost::asio::ip::tcp::socket socket) {
+    try {
+        std::string request{};
+        co_await boost::asio::async_read_until(socket, boost::asio::dynamic_buffer(request, MaxRequestSize), "\r\n\r\n",
+                                               boost::asio::use_awaitable);
+        Metrics::PrometheusWriter writer{};
+        if (collector) {
+            collector(writer);
+        }
+        writer.registry(Metrics::Registry::get());
+        const auto& body = writer.getText();
+        std::string header{"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "};
+        header.append(std::to_string(body.size())).append("\r\nConnection: close\r\n\r\n");
+        std::array<boost::asio::const_buffer, 2> response{boost::asio::buffer(header), boost::asio::buffer(body)};
+        co_await boost::asio::async_write(socket, response, boost::asio::use_awaitable);
+        socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+    } catch (boost::system::system_error& error) {
+        Log::debug("AdminAcceptor::serve: {}", error.what());
+    }
+}
+
 } // namespace Watchdog
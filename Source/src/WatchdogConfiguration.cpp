@@ -0,0 +1,110 @@
+#include "WatchdogConfiguration.hpp"
+#include "Logging.hpp"
+#include <thread>
+
+namespace Watchdog {
+
+ServerConfiguration::ServerConfiguration() : workingThreads{std::max(1u, std::thread::hardware_concurrency())} {}
+
+ServerConfigurationReader::ServerConfigurationReader(ServerConfiguration& serverConfiguration)
+    : serverConfiguration{serverConfiguration} {
+    configFile.open(configurationPath);
+}
+
+ServerConfigurationReader::~ServerConfigurationReader() {
+    if (configFile.is_open()) {
+        configFile.close();
+    }
+}
+
+bool ServerConfigurationReader::readConfiguration() {
+    bool readConfiguration{false};
+    if (configFile.is_open()) {
+        try {
+            jsonConfig = nlohmann::json::parse(configFile);
+            readConfiguration = this->read();
+        } catch (nlohmann::json::exception& ex) {
+            readConfiguration = false;
+        }
+    }
+    return readConfiguration;
+}
+
+bool ServerConfigurationReader::read() {
+    bool read{true};
+    if (jsonConfig.contains("WorkingThreads")) {
+        auto workingThreads = jsonConfig["WorkingThreads"].get<uint32_t>();
+        if (workingThreads == 0) {
+            Log::error("Read watchdog configuration contains invalid number of working threads");
+            read = false;
+        } else {
+            serverConfiguration.workingThreads = workingThreads;
+        }
+    }
+    if (jsonConfig.contains("IoContextPerThread")) {
+        serverConfiguration.ioContextPerThread = jsonConfig["IoContextPerThread"].get<bool>();
+    }
+    if (jsonConfig.contains("ConnectionsDispatch")) {
+        auto connectionsDispatch = jsonConfig["ConnectionsDispatch"].get<std::string>();
+        if (connectionsDispatch == "RoundRobin") {
+            serverConfiguration.connectionsDispatch = ConnectionsDispatch::RoundRobin;
+        } else if (connectionsDispatch == "LeastLoad") {
+            serverConfiguration.connectionsDispatch = ConnectionsDispatch::LeastLoad;
+        } else {
+            Log::error("Read watchdog configuration contains unknown connections dispatch: {}", connectionsDispatch);
+            read = false;
+        }
+    }
+    if (jsonConfig.contains("PinThreads")) {
+        serverConfiguration.pinThreads = jsonConfig["PinThreads"].get<bool>();
+    }
+    if (jsonConfig.contains("StorageThreads")) {
+        auto storageThreads = jsonConfig["StorageThreads"].get<uint32_t>();
+        if (storageThreads == 0) {
+            Log::error("Read watchdog configuration contains invalid number of storage threads");
+            read = false;
+        } else {
+            serverConfiguration.storageThreads = storageThreads;
+        }
+    }
+    if (jsonConfig.contains("AsyncLog")) {
+        serverConfiguration.asyncLog = jsonConfig["AsyncLog"].get<bool>();
+    }
+    if (jsonConfig.contains("LogQueueSize")) {
+        auto logQueueSize = jsonConfig["LogQueueSize"].get<uint32_t>();
+        if (logQueueSize == 0) {
+            Log::error("Read watchdog configuration contains invalid log queue size");
+            read = false;
+        } else {
+            serverConfiguration.asyncLogConfiguration.queueSize = logQueueSize;
+        }
+    }
+    if (jsonConfig.contains("LogOverflowPolicy")) {
+        auto overflowPolicy = jsonConfig["LogOverflowPolicy"].get<std::string>();
+        if (overflowPolicy == "Block") {
+            serverConfiguration.asyncLogConfiguration.overflowPolicy = LogOverflowPolicy::Block;
+        } else if (overflowPolicy == "DropOldest") {
+            serverConfiguration.asyncLogConfiguration.overflowPolicy = LogOverflowPolicy::DropOldest;
+        } else if (overflowPolicy == "DropNew") {
+            serverConfiguration.asyncLogConfiguration.overflowPolicy = LogOverflowPolicy::DropNew;
+        } else {
+            Log::error("Read watchdog configuration contains unknown log overflow policy: {}", overflowPolicy);
+            read = false;
+        }
+    }
+    if (jsonConfig.contains("AdminEndpoint")) {
+        serverConfiguration.adminEndpoint = jsonConfig["AdminEndpoint"].get<bool>();
+    }
+    if (jsonConfig.contains("AdminPort")) {
+        auto adminPort = jsonConfig["AdminPort"].get<uint16_t>();
+        if (adminPort == 0) {
+            Log::error("Read watchdog configuration contains invalid admin port");
+            read = false;
+        } else {
+            serverConfiguration.adminPort = adminPort;
+        }
+    }
+    return read;
+}
+
+} // namespace Watchdog
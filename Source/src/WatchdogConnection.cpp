@@ -1,210 +1,315 @@
 #include "WatchdogConnection.hpp"
+#include "Metrics.hpp"
 #include <functional>
+#include <string>
 #include <thread>
 
 namespace Watchdog {
 
 constexpr size_t PingTimerExpirationIntervalInMilliseconds = 8000;
 
-ModuleConnection::ModuleConnection(boost::asio::io_context& ioContext, std::map<std::thread::id, Mongo::ModulesCollection>& mCollection,
-                                   std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection)
-    : Connection::TcpConnection<WatchdogModule::Operation>(ioContext), timer{ioContext}, modulesCollection{mCollection},
-      servicesCollection{servicesCollection} {}
+namespace {
 
-void ModuleConnection::handleReceivedMessage(std::unique_ptr<Communication::Message<WatchdogModule::Operation>> receivedMessage) {
-    auto myDbConnection = modulesCollection.find(std::this_thread::get_id());
-    if (myDbConnection == std::end(modulesCollection)) {
-        Log::critical("WatchdogConnection::handleReceivedMessage(): Not found suitable mongodb client");
-    } else {
-        auto& collection = myDbConnection->second;
+struct OperationMetrics {
+    Metrics::Counter* requests{nullptr};
+    Metrics::Histogram* latency{nullptr};
+};
+
+// Requests count and handling latency of every operation of protocol, indexed by operation code
+template <typename Operation, size_t OperationsCount, typename NameGetter>
+std::array<OperationMetrics, OperationsCount> makeOperationsMetrics(const std::string& protocol, NameGetter&& operationName) {
+    std::array<OperationMetrics, OperationsCount> operationsMetrics{};
+    for (size_t operationCode = 0; operationCode < OperationsCount; operationCode++) {
+        std::string labels{"protocol=\"" + protocol + "\",operation=\"" + operationName(static_cast<Operation>(operationCode)) + "\""};
+        operationsMetrics[operationCode].requests = &Metrics::Registry::get().counter("watchdog_requests_total", labels);
+        operationsMetrics[operationCode].latency = &Metrics::Registry::get().histogram("watchdog_request_duration_nanoseconds", labels);
+    }
+    return operationsMetrics;
+}
+
+Metrics::Counter& activeConnections(const std::string& acceptor) {
+    return Metrics::Registry::get().counter("watchdog_active_connections", "acceptor=\"" + acceptor + "\"");
+}
+
+} // namespace
+
+ModuleConnection::ModuleConnection(boost::asio::io_context& ioContext, Connection::TimerWheel& timerWheel, ModulesRegistry& modulesRegistry,
+                                   ServicesRegistry& servicesRegistry, StorageExecutor& storageExecutor)
+    : WatchdogTcpConnection<WatchdogModule::Operation>(ioContext, timerWheel), modulesRegistry{modulesRegistry},
+      servicesRegistry{servicesRegistry}, storageExecutor{storageExecutor} {
+    static auto& connections = activeConnections("modules");
+    connections.add();
+    // Handlers are owned by connection, so they may refer to it directly. Ping handler runs on strand and restarts timer at once,
+    // storage bound handlers run on storage executor and only touch their own copy of connection state.
+    auto setTimer = [this]() { this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds); };
+    auto requestTimer = [this]() { this->storageTimerRequested = true; };
+    this->requestHandlers[WatchdogModule::Operation::ConnectRequest] =
+        std::make_unique<ModuleConnectRequestHandler>(this->storageAuthenticationData, this->modulesRegistry, requestTimer);
+    this->requestHandlers[WatchdogModule::Operation::PingRequest] =
+        std::make_unique<ModulePingRequestHandler>(this->authenticationData, setTimer);
+    this->requestHandlers[WatchdogModule::Operation::ReconnectRequest] =
+        std::make_unique<ModuleReconnectRequestHandler>(this->storageAuthenticationData, this->modulesRegistry, requestTimer);
+    this->requestHandlers[WatchdogModule::Operation::ShutdownRequest] =
+        std::make_unique<ModuleShutdownRequestHandler>(this->storageAuthenticationData, this->modulesRegistry);
+}
+
+ModuleConnection::~ModuleConnection() {
+    static auto& connections = activeConnections("modules");
+    connections.sub();
+    Log::debug("Module connection terminated");
+}
 
-        if (!receivedMessage) {
-            Log::error("handleReceivedMessage: receivedMessage is nullptr");
+boost::asio::awaitable<void>
+ModuleConnection::handleReceivedMessage(Communication::MessageView<WatchdogModule::Operation> receivedMessage) {
+    static const auto operationsMetrics = makeOperationsMetrics<WatchdogModule::Operation, WatchdogModule::Operation_ARRAYSIZE>(
+        "module", [](auto operationCode) { return WatchdogModule::Operation_Name(operationCode); });
+    auto* responseCreator = this->getRequestHandler(receivedMessage.header.operationCode);
+    if (responseCreator) {
+        // Handler found, so operation code is within metrics array
+        auto& operationMetrics = operationsMetrics[receivedMessage.header.operationCode];
+        operationMetrics.requests->add();
+        Metrics::ScopedTimer timer{*operationMetrics.latency};
+        std::optional<Communication::Message<WatchdogModule::Operation>> response{std::nullopt};
+        if (responseCreator->requiresStorage()) {
+            // Handler blocks on database, it runs on storage executor while this coroutine waits for its response. Requests
+            // of connection are handled one at a time, so strand does not touch handler copy of state until it is applied back.
+            this->storageAuthenticationData = this->authenticationData;
+            this->storageTimerRequested = false;
+            response = co_await boost::asio::co_spawn(
+                this->storageExecutor.getExecutor(),
+                [this, responseCreator, messageBody = receivedMessage.body]()
+                    -> boost::asio::awaitable<std::optional<Communication::Message<WatchdogModule::Operation>>> {
+                    co_return this->createMessageResponse(*responseCreator, messageBody);
+                },
+                boost::asio::use_awaitable);
+            this->applyStorageResult();
         } else {
-            auto& [messageHeader, messageBody] = *receivedMessage;
-            auto responseCreator = this->getRequestHandler(messageHeader.operationCode, collection);
-            if (responseCreator) {
-                this->createMessageResponse(std::move(responseCreator), messageBody);
-            }
+            response = this->createMessageResponse(*responseCreator, receivedMessage.body);
+        }
+        if (response) {
+            this->sendMessage(std::move(*response));
         }
     }
 }
 
-void ModuleConnection::createMessageResponse(std::unique_ptr<ModuleRequestHandler> responseCreator, std::string& messageBody) {
-    if (responseCreator) {
-        try {
-            auto response = responseCreator->createResponse(messageBody);
-            this->sendMessage(response);
-        } catch (ModuleRequestHandlerException& exception) {
+std::optional<Communication::Message<WatchdogModule::Operation>>
+ModuleConnection::createMessageResponse(ModuleRequestHandler& responseCreator, std::string_view messageBody) {
+    std::optional<Communication::Message<WatchdogModule::Operation>> response{std::nullopt};
+    try {
+        response = responseCreator.createResponse(messageBody);
+    } catch (ModuleRequestHandlerException& exception) {
+        Log::info("Caught ModuleRequestHandlerException exception");
+    } catch (std::exception& exception) {
+        Log::error("Caught standard exception: {}", exception.what());
+    } catch (...) {
+        Log::error("Caught unknown exception");
+    }
+    return response;
+}
 
-        } catch (std::exception_ptr& exception) {
-            // Handle exception
+void ModuleConnection::applyStorageResult() {
+    this->authenticationData = this->storageAuthenticationData;
+    if (this->storageTimerRequested) {
+        if (this->socket->is_open()) {
+            this->enableRequestedCompactPings();
+            this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds);
+        } else {
+            // Connection was closed while module was being connected, its record must not stay connected
+            Log::info("Module connected after its connection was closed, setting it back to disconnected");
+            this->disconnect();
         }
     }
 }
 
 void ModuleConnection::disconnect() {
-    auto myDbConnection = this->modulesCollection.find(std::this_thread::get_id());
-    if (myDbConnection == std::end(modulesCollection)) {
-        Log::critical("WatchdogConnection::disconnect(): Not found suitable mongodb client");
-    } else if (this->authenticationData.identifier == -1) {
+    if (this->authenticationData.identifier == -1) {
         Log::error("authenticationData.identifier is not set - cannot set to disconnect state");
     } else {
-        auto& collection = myDbConnection->second;
-        auto record = collection.getModule(this->authenticationData.identifier);
-        if (!record.has_value()) {
+        auto transitionResult = this->modulesRegistry.transition(this->authenticationData.identifier,
+                                                                 {ModuleRecord::ConnectionState::Connected},
+                                                                 ModuleRecord::ConnectionState::Disconnected);
+        if (transitionResult == TransitionResult::NotFound) {
             Log::critical("No record to update in database");
-        } else if (record->connectionState != ModuleRecord::ConnectionState::Connected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             Log::trace("Disconnected in invalid state");
         } else {
             Log::trace("Set disconnected state in database");
-            record->connectionState = ModuleRecord::ConnectionState::Disconnected;
-            collection.updateModule(std::move(*record));
         }
     }
 
     if (this->socket->is_open()) {
         this->socket->close();
     }
-    this->timer.cancel();
+    this->cancelTimer();
 }
 
 void ModuleConnection::onTimerExpiration() {
-    Log::info("Timer expired properly");
-    auto now = boost::posix_time::microsec_clock::local_time();
-    if ((now - last_ping).total_milliseconds() >= PingTimerExpirationIntervalInMilliseconds) {
+    Log::trace("Timer expired properly");
+    // Ping restarting timer may arrive after wheel expired it, then timer is re-armed for rest of its interval
+    if (this->timerDeadlinePassed()) {
         Log::error("WatchdogConnection::onTimerExpiration(): Not received ping - disconnecting");
         this->disconnect();
     }
-    last_ping = boost::posix_time::microsec_clock::local_time();
-}
-
-std::unique_ptr<ModuleRequestHandler> ModuleConnection::getRequestHandler(const WatchdogModule::Operation& operationCode,
-                                                                          Mongo::ModulesCollection& mCollection) {
-    std::unique_ptr<ModuleRequestHandler> requestHandler{nullptr};
-    auto setTimer = std::bind([](auto connection) { connection->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds); },
-                              this->shared_from_this());
-    switch (operationCode) {
-    case WatchdogModule::Operation::ConnectRequest:
-        requestHandler = std::make_unique<ModuleConnectRequestHandler>(this->authenticationData, mCollection, setTimer);
-        break;
-    case WatchdogModule::Operation::PingRequest:
-        requestHandler = std::make_unique<ModulePingRequestHandler>(this->authenticationData, setTimer);
-        break;
-    case WatchdogModule::Operation::ReconnectRequest:
-        requestHandler = std::make_unique<ModuleReconnectRequestHandler>(this->authenticationData, mCollection, setTimer);
-        break;
-    case WatchdogModule::Operation::ShutdownRequest:
-        requestHandler = std::make_unique<ModuleShutdownRequestHandler>(this->authenticationData, mCollection);
-        break;
-    default:
-        break;
+}
+
+bool ModuleConnection::acceptPing(uint32_t sequenceCode) {
+    bool accepted{sequenceCode == this->authenticationData.sequenceCode};
+    if (accepted) {
+        this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds);
+    } else {
+        Log::error("ModuleConnection::acceptPing(): Dropped ping with invalid sequence code");
+    }
+    return accepted;
+}
+
+ModuleRequestHandler* ModuleConnection::getRequestHandler(const WatchdogModule::Operation& operationCode) {
+    ModuleRequestHandler* requestHandler{nullptr};
+    // Operation code comes straight from received header
+    if (static_cast<size_t>(operationCode) < this->requestHandlers.size()) {
+        requestHandler = this->requestHandlers[operationCode].get();
     }
     return requestHandler;
 }
 
 void ModuleConnection::setTimerWaitForConnection() { this->setTimerExpiration(3000); }
 
-ServiceConnection::ServiceConnection(boost::asio::io_context& ioContext,
-                                     std::map<std::thread::id, Mongo::ModulesCollection>& modulesCollection,
-                                     std::map<std::thread::id, Mongo::ServicesCollection>& servicesCollection)
-    : Connection::TcpConnection<WatchdogService::Operation>{ioContext}, servicesCollection{servicesCollection}, modulesCollection{
-                                                                                                                    modulesCollection} {}
+ServiceConnection::ServiceConnection(boost::asio::io_context& ioContext, Connection::TimerWheel& timerWheel,
+                                     ModulesRegistry& modulesRegistry, ServicesRegistry& servicesRegistry,
+                                     StorageExecutor& storageExecutor)
+    : WatchdogTcpConnection<WatchdogService::Operation>{ioContext, timerWheel}, modulesRegistry{modulesRegistry},
+      servicesRegistry{servicesRegistry}, storageExecutor{storageExecutor} {
+    static auto& connections = activeConnections("services");
+    connections.add();
+    // Handlers are owned by connection, so they may refer to it directly. Ping handler runs on strand and restarts timer at once,
+    // storage bound handlers run on storage executor and only touch their own copy of connection state.
+    auto setTimer = [this]() { this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds); };
+    auto requestTimer = [this]() { this->storageTimerRequested = true; };
+    this->requestHandlers[WatchdogService::Operation::ConnectRequest] =
+        std::make_unique<ServiceConnectRequestHandler>(this->storageAuthenticationData, this->servicesRegistry, requestTimer);
+    this->requestHandlers[WatchdogService::Operation::PingRequest] =
+        std::make_unique<ServicePingRequestHandler>(this->serviceAuthenticationData, setTimer);
+    this->requestHandlers[WatchdogService::Operation::ReconnectRequest] =
+        std::make_unique<ServiceReconnectRequestHandler>(this->storageAuthenticationData, this->servicesRegistry, requestTimer);
+    this->requestHandlers[WatchdogService::Operation::ShutdownRequest] =
+        std::make_unique<ServiceShutdownRequestHandler>(this->storageAuthenticationData, this->servicesRegistry);
+}
 
-ServiceConnection::~ServiceConnection() { Log::debug("Service connection terminated"); }
+ServiceConnection::~ServiceConnection() {
+    static auto& connections = activeConnections("services");
+    connections.sub();
+    Log::debug("Service connection terminated");
+}
+
+void ServiceConnection::applyStorageResult() {
+    this->serviceAuthenticationData = this->storageAuthenticationData;
+    if (this->storageTimerRequested) {
+        if (this->socket->is_open()) {
+            this->enableRequestedCompactPings();
+            this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds);
+        } else {
+            // Connection was closed while service was being connected, its record must not stay connected
+            Log::info("Service connected after its connection was closed, setting it back to disconnected");
+            this->disconnect();
+        }
+    }
+}
 
 void ServiceConnection::disconnect() {
-    auto myDbConnection = this->servicesCollection.find(std::this_thread::get_id());
-    if (myDbConnection == std::end(servicesCollection)) {
-        Log::critical("ServiceConnection::disconnect(): Not found suitable mongodb client");
-    } else if (this->serviceAuthenticationData.identifier == -1) {
+    if (this->serviceAuthenticationData.identifier == -1) {
         Log::error("authenticationData.identifier is not set - cannot set to disconnect state");
     } else {
-        auto& collection = myDbConnection->second;
-        auto record = collection.getService(this->serviceAuthenticationData.identifier);
-        if (!record.has_value()) {
+        auto transitionResult = this->servicesRegistry.transition(this->serviceAuthenticationData.identifier,
+                                                                  {ServiceRecord::ConnectionState::Connected},
+                                                                  ServiceRecord::ConnectionState::Disconnected);
+        if (transitionResult == TransitionResult::NotFound) {
             Log::critical("No record to update in database");
-        } else if (record->connectionState != ServiceRecord::ConnectionState::Connected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             Log::trace("Disconnected in invalid state");
         } else {
             Log::trace("Set disconnected state in database");
-            record->connectionState = ServiceRecord::ConnectionState::Disconnected;
-            collection.updateService(std::move(*record));
         }
     }
 
     if (this->socket->is_open()) {
         this->socket->close();
     }
-    this->timer.cancel();
-}
-
-std::unique_ptr<ServiceRequestHandler> ServiceConnection::getRequestHandler(const WatchdogService::Operation& operationCode,
-                                                                            Mongo::ServicesCollection& servicesCollection) {
-    std::unique_ptr<ServiceRequestHandler> requestHandler{nullptr};
-    auto setTimer = std::bind([](auto connection) { connection->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds); },
-                              this->shared_from_this());
-    switch (operationCode) {
-    case WatchdogService::Operation::ConnectRequest:
-        requestHandler = std::make_unique<ServiceConnectRequestHandler>(this->serviceAuthenticationData, servicesCollection, setTimer);
-        break;
-    case WatchdogService::Operation::PingRequest:
-        requestHandler = std::make_unique<ServicePingRequestHandler>(this->serviceAuthenticationData, setTimer);
-        break;
-    case WatchdogService::Operation::ReconnectRequest:
-        requestHandler = std::make_unique<ServiceReconnectRequestHandler>(this->serviceAuthenticationData, servicesCollection, setTimer);
-        break;
-    case WatchdogService::Operation::ShutdownRequest:
-        requestHandler = std::make_unique<ServiceShutdownRequestHandler>(this->serviceAuthenticationData, servicesCollection);
-        break;
-    default:
-        break;
-    }
-    return requestHandler;
+    this->cancelTimer();
 }
 
-void ServiceConnection::handleReceivedMessage(std::unique_ptr<Communication::Message<WatchdogService::Operation>> receivedMessage) {
-    auto myDbConnection = this->servicesCollection.find(std::this_thread::get_id());
-    if (myDbConnection == std::end(servicesCollection)) {
-        Log::critical("ServiceConnection::handleReceivedMessage(): Not found suitable mongodb client");
+bool ServiceConnection::acceptPing(uint32_t sequenceCode) {
+    bool accepted{sequenceCode == this->serviceAuthenticationData.sequenceCode};
+    if (accepted) {
+        this->setTimerExpiration(PingTimerExpirationIntervalInMilliseconds);
     } else {
-        auto& collection = myDbConnection->second;
+        Log::error("ServiceConnection::acceptPing(): Dropped ping with invalid sequence code");
+    }
+    return accepted;
+}
 
-        if (!receivedMessage) {
-            Log::error("ServiceConnection::handleReceivedMessage(): receivedMessage is nullptr");
-        } else {
-            auto& [messageHeader, messageBody] = *receivedMessage;
-            auto responseCreator = this->getRequestHandler(messageHeader.operationCode, collection);
-            if (responseCreator) {
-                this->createMessageResponse(std::move(responseCreator), messageBody);
-            }
-        }
+ServiceRequestHandler* ServiceConnection::getRequestHandler(const WatchdogService::Operation& operationCode) {
+    ServiceRequestHandler* requestHandler{nullptr};
+    // Operation code comes straight from received header
+    if (static_cast<size_t>(operationCode) < this->requestHandlers.size()) {
+        requestHandler = this->requestHandlers[operationCode].get();
     }
+    return requestHandler;
 }
 
-void ServiceConnection::createMessageResponse(std::unique_ptr<ServiceRequestHandler> responseCreator, std::string& messageBody) {
+boost::asio::awaitable<void>
+ServiceConnection::handleReceivedMessage(Communication::MessageView<WatchdogService::Operation> receivedMessage) {
+    static const auto operationsMetrics = makeOperationsMetrics<WatchdogService::Operation, WatchdogService::Operation_ARRAYSIZE>(
+        "service", [](auto operationCode) { return WatchdogService::Operation_Name(operationCode); });
+    auto* responseCreator = this->getRequestHandler(receivedMessage.header.operationCode);
     if (responseCreator) {
-        try {
-            auto response = responseCreator->createResponse(messageBody);
-            this->sendMessage(response);
-        } catch (ServiceRequestHandlerException& exception) {
-            Log::info("Caught ServiceRequestHandlerException exception");
-        } catch (std::exception_ptr& exception) {
-            Log::error("Caught standard exception");
-        } catch (...) {
-            Log::critical("Caught unknown exception");
+        // Handler found, so operation code is within metrics array
+        auto& operationMetrics = operationsMetrics[receivedMessage.header.operationCode];
+        operationMetrics.requests->add();
+        Metrics::ScopedTimer timer{*operationMetrics.latency};
+        std::optional<Communication::Message<WatchdogService::Operation>> response{std::nullopt};
+        if (responseCreator->requiresStorage()) {
+            // Handler blocks on database, it runs on storage executor while this coroutine waits for its response. Requests
+            // of connection are handled one at a time, so strand does not touch handler copy of state until it is applied back.
+            this->storageAuthenticationData = this->serviceAuthenticationData;
+            this->storageTimerRequested = false;
+            response = co_await boost::asio::co_spawn(
+                this->storageExecutor.getExecutor(),
+                [this, responseCreator, messageBody = receivedMessage.body]()
+                    -> boost::asio::awaitable<std::optional<Communication::Message<WatchdogService::Operation>>> {
+                    co_return this->createMessageResponse(*responseCreator, messageBody);
+                },
+                boost::asio::use_awaitable);
+            this->applyStorageResult();
+        } else {
+            response = this->createMessageResponse(*responseCreator, receivedMessage.body);
+        }
+        if (response) {
+            this->sendMessage(std::move(*response));
         }
     }
 }
 
+std::optional<Communication::Message<WatchdogService::Operation>>
+ServiceConnection::createMessageResponse(ServiceRequestHandler& responseCreator, std::string_view messageBody) {
+    std::optional<Communication::Message<WatchdogService::Operation>> response{std::nullopt};
+    try {
+        response = responseCreator.createResponse(messageBody);
+    } catch (ServiceRequestHandlerException& exception) {
+        Log::info("Caught ServiceRequestHandlerException exception");
+    } catch (std::exception& exception) {
+        Log::error("Caught standard exception: {}", exception.what());
+    } catch (...) {
+        Log::error("Caught unknown exception");
+    }
+    return response;
+}
+
 void ServiceConnection::onTimerExpiration() {
-    Log::info("Timer expired properly");
-    auto now = boost::posix_time::microsec_clock::local_time();
-    if ((now - last_ping).total_milliseconds() >= PingTimerExpirationIntervalInMilliseconds) {
+    Log::trace("Timer expired properly");
+    // Ping restarting timer may arrive after wheel expired it, then timer is re-armed for rest of its interval
+    if (this->timerDeadlinePassed()) {
         Log::error("ServiceConnection::onTimerExpiration(): Not received ping - disconnecting");
         this->disconnect();
     }
-    last_ping = boost::posix_time::microsec_clock::local_time();
 }
 
 } // namespace Watchdog
\ No newline at end of file
@@ -9,10 +9,21 @@ int main() {
     Mongo::DbEnvironment::initialize();
     if (!Mongo::DbEnvironment::isConnected()) {
         Log::critical("main: Failed connection to mongoDB");
+    } else if (!Mongo::DbEnvironment::ensureIndexes()) {
+        Log::critical("main: Unique mongoDB indexes are missing, identifiers could not be kept unique");
     } else {
-        Watchdog::WatchdogServer watchdog{};
+        Watchdog::ServerConfiguration serverConfiguration{};
+        Watchdog::ServerConfigurationReader serverConfigurationReader{serverConfiguration};
+        if (!serverConfigurationReader.readConfiguration()) {
+            Log::info("main: Watchdog configuration not read, using defaults");
+        }
+        if (serverConfiguration.asyncLog) {
+            Log::startAsync(serverConfiguration.asyncLogConfiguration);
+        }
+        Watchdog::WatchdogServer watchdog{serverConfiguration};
         watchdog.setupSignalHandlers();
         watchdog.setAllConnectedToDisconnectedState();
+        watchdog.loadRegistries();
         if (!watchdog.startAcceptingConnections()) {
             Log::critical("main: Failed to start accepting connections");
         } else if (!watchdog.createWorkingThreads()) {
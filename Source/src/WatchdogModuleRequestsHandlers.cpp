@@ -15,21 +15,29 @@ uint32_t ModuleRequestHandler::generateNewSequenceCode(uint32_t oldSequenceCode)
     return newSequenceCode;
 }
 
+void ModuleRequestHandler::setResponseBody(const google::protobuf::MessageLite& response) {
+    size_t responseSize = response.ByteSizeLong();
+    Communication::BufferPool::prepare(this->responseMessage.body, responseSize);
+    response.SerializeToArray(this->responseMessage.body.data(), static_cast<int>(responseSize));
+    this->responseMessage.header.size = responseSize;
+}
+
 ModuleConnectRequestHandler::ModuleConnectRequestHandler(ModuleAuthenticationData& authenticationData,
-                                                         Mongo::ModulesCollection& modulesCollection, std::function<void()> timerControl)
-    : ModuleRequestHandler{authenticationData}, modulesCollection{modulesCollection}, timerControl{std::move(timerControl)} {
+                                                         ModulesRegistry& modulesRegistry, std::function<void()> timerControl)
+    : ModuleRequestHandler{authenticationData}, modulesRegistry{modulesRegistry}, timerControl{std::move(timerControl)} {
     this->responseMessage.header.operationCode = WatchdogModule::Operation::ConnectResponse;
 }
 
-Communication::Message<WatchdogModule::Operation> ModuleConnectRequestHandler::createResponse(std::string& receivedMessage) {
-    if (!this->connectRequest.ParseFromString(receivedMessage)) {
+Communication::Message<WatchdogModule::Operation> ModuleConnectRequestHandler::createResponse(std::string_view receivedMessage) {
+    // Handler is reused for all requests of connection
+    this->connectResponse.Clear();
+    if (!this->connectRequest.ParseFromArray(receivedMessage.data(), static_cast<int>(receivedMessage.size()))) {
         Log::error("Failed to parse received module connect request");
         throw ModuleRequestHandlerException{ModuleRequestHandlerException::ErrorCode::FailedToParse};
     }
     this->processConnectRequest();
-    this->connectResponse.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->connectResponse);
+    return std::move(this->responseMessage);
 }
 
 void ModuleConnectRequestHandler::processConnectRequest() {
@@ -37,21 +45,20 @@ void ModuleConnectRequestHandler::processConnectRequest() {
         this->connectResponse.set_responsecode(WatchdogModule::ConnectResponseData::NotModuleIdentifier);
     } else {
         const Types::ModuleIdentifier& moduleIdentifier = connectRequest.identifier();
-        auto moduleRecord = modulesCollection.getModule(moduleIdentifier);
-        if (!moduleRecord.has_value()) {
+        auto transitionResult = modulesRegistry.transition(
+            moduleIdentifier, {ModuleRecord::ConnectionState::Registered, ModuleRecord::ConnectionState::Disconnected},
+            ModuleRecord::ConnectionState::Connected);
+        if (transitionResult == TransitionResult::NotFound) {
             this->connectResponse.set_responsecode(WatchdogModule::ConnectResponseData::ModuleNotExists);
-        } else if (moduleRecord->connectionState == ModuleRecord::ConnectionState::Connected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             this->connectResponse.set_responsecode(WatchdogModule::ConnectResponseData::InvalidConnectionState);
         } else {
             Log::info("ModuleConnectRequestHandler::processConnectRequest connected new module");
-            moduleRecord->connectionState = ModuleRecord::ConnectionState::Connected;
             this->authenticationData.identifier = connectRequest.identifier();
-            if (modulesCollection.updateModule(std::move(*moduleRecord))) {
-                this->authenticationData.sequenceCode = this->generateNewSequenceCode();
-                this->connectResponse.set_responsecode(WatchdogModule::ConnectResponseData::Success);
-                this->connectResponse.set_sequencecode(this->authenticationData.sequenceCode);
-                this->timerControl();
-            }
+            this->authenticationData.sequenceCode = this->generateNewSequenceCode();
+            this->connectResponse.set_responsecode(WatchdogModule::ConnectResponseData::Success);
+            this->connectResponse.set_sequencecode(this->authenticationData.sequenceCode);
+            this->timerControl();
         }
     }
 }
@@ -61,8 +68,10 @@ ModulePingRequestHandler::ModulePingRequestHandler(ModuleAuthenticationData& aut
     this->responseMessage.header.operationCode = WatchdogModule::Operation::PingResponse;
 }
 
-Communication::Message<WatchdogModule::Operation> ModulePingRequestHandler::createResponse(std::string& receivedMessage) {
-    if (!this->pingRequest.ParseFromString(receivedMessage)) {
+Communication::Message<WatchdogModule::Operation> ModulePingRequestHandler::createResponse(std::string_view receivedMessage) {
+    // Handler is reused for all requests of connection
+    this->pingResponse.Clear();
+    if (!this->pingRequest.ParseFromArray(receivedMessage.data(), static_cast<int>(receivedMessage.size()))) {
         Log::error("Failed to parse received module ping request");
         throw ModuleRequestHandlerException{ModuleRequestHandlerException::ErrorCode::FailedToParse};
     }
@@ -73,27 +82,27 @@ Communication::Message<WatchdogModule::Operation> ModulePingRequestHandler::crea
     } else {
         throw ModuleRequestHandlerException(ModuleRequestHandlerException::ErrorCode::Dropped);
     }
-    this->pingResponse.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->pingResponse);
+    return std::move(this->responseMessage);
 }
 
 ModuleReconnectRequestHandler::ModuleReconnectRequestHandler(ModuleAuthenticationData& authenticationData,
-                                                             Mongo::ModulesCollection& modulesCollection,
+                                                             ModulesRegistry& modulesRegistry,
                                                              std::function<void()> timerControl)
-    : ModuleRequestHandler{authenticationData}, modulesCollection{modulesCollection}, timerControl{std::move(timerControl)} {
+    : ModuleRequestHandler{authenticationData}, modulesRegistry{modulesRegistry}, timerControl{std::move(timerControl)} {
     this->responseMessage.header.operationCode = WatchdogModule::Operation::ReconnectResponse;
 }
 
-Communication::Message<WatchdogModule::Operation> ModuleReconnectRequestHandler::createResponse(std::string& receivedMessage) {
-    if (!this->reconnectRequest.ParseFromString(receivedMessage)) {
+Communication::Message<WatchdogModule::Operation> ModuleReconnectRequestHandler::createResponse(std::string_view receivedMessage) {
+    // Handler is reused for all requests of connection
+    this->reconnectResponse.Clear();
+    if (!this->reconnectRequest.ParseFromArray(receivedMessage.data(), static_cast<int>(receivedMessage.size()))) {
         Log::error("Failed to parse received module ping request");
         throw ModuleRequestHandlerException{ModuleRequestHandlerException::ErrorCode::FailedToParse};
     }
     this->processReconnectRequest();
-    this->reconnectResponse.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->reconnectResponse);
+    return std::move(this->responseMessage);
 }
 
 void ModuleReconnectRequestHandler::processReconnectRequest() {
@@ -101,29 +110,29 @@ void ModuleReconnectRequestHandler::processReconnectRequest() {
         this->reconnectResponse.set_responsecode(WatchdogModule::ReconnectResponseData::NotModuleIdentifier);
     } else {
         const Types::ModuleIdentifier& moduleIdentifier = reconnectRequest.identifier();
-        auto moduleRecord = modulesCollection.getModule(moduleIdentifier);
-        if (!moduleRecord.has_value()) {
+        auto transitionResult = modulesRegistry.transition(moduleIdentifier, {ModuleRecord::ConnectionState::Disconnected},
+                                                           ModuleRecord::ConnectionState::Connected);
+        if (transitionResult == TransitionResult::NotFound) {
             this->reconnectResponse.set_responsecode(WatchdogModule::ReconnectResponseData::ModuleNotExists);
-        } else if (moduleRecord->connectionState != ModuleRecord::ConnectionState::Disconnected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             this->reconnectResponse.set_responsecode(WatchdogModule::ReconnectResponseData::InvalidConnectionState);
         } else {
-            moduleRecord->connectionState = ModuleRecord::ConnectionState::Connected;
-            if (modulesCollection.updateModule(std::move(*moduleRecord))) {
-                this->authenticationData.sequenceCode = this->generateNewSequenceCode(this->authenticationData.sequenceCode);
-                this->reconnectResponse.set_sequencecode(this->authenticationData.sequenceCode);
-                this->reconnectResponse.set_responsecode(WatchdogModule::ReconnectResponseData::Success);
-                this->timerControl();
-            }
+            // Connection may be new one, disconnect must find record it reconnected
+            this->authenticationData.identifier = moduleIdentifier;
+            this->authenticationData.sequenceCode = this->generateNewSequenceCode(this->authenticationData.sequenceCode);
+            this->reconnectResponse.set_sequencecode(this->authenticationData.sequenceCode);
+            this->reconnectResponse.set_responsecode(WatchdogModule::ReconnectResponseData::Success);
+            this->timerControl();
         }
     }
 }
 
 ModuleShutdownRequestHandler::ModuleShutdownRequestHandler(ModuleAuthenticationData& authenticationData,
-                                                           Mongo::ModulesCollection& modulesCollection)
-    : ModuleRequestHandler{authenticationData}, modulesCollection{modulesCollection} {}
+                                                           ModulesRegistry& modulesRegistry)
+    : ModuleRequestHandler{authenticationData}, modulesRegistry{modulesRegistry} {}
 
-Communication::Message<WatchdogModule::Operation> ModuleShutdownRequestHandler::createResponse(std::string& receivedRequest) {
-    if (!this->shutdownRequest.ParseFromString(receivedRequest)) {
+Communication::Message<WatchdogModule::Operation> ModuleShutdownRequestHandler::createResponse(std::string_view receivedRequest) {
+    if (!this->shutdownRequest.ParseFromArray(receivedRequest.data(), static_cast<int>(receivedRequest.size()))) {
         Log::error("Failed to parse received module ping request");
         throw ModuleRequestHandlerException{ModuleRequestHandlerException::ErrorCode::FailedToParse};
     }
@@ -136,15 +145,11 @@ void ModuleShutdownRequestHandler::processShutdownRequest() {
         throw ModuleRequestHandlerException(ModuleRequestHandlerException::ErrorCode::Dropped);
     } else {
         const Types::ModuleIdentifier& moduleIdentifier = shutdownRequest.identifier();
-        auto moduleRecord = modulesCollection.getModule(moduleIdentifier);
-        if (!moduleRecord.has_value()) {
+        auto transitionResult = this->modulesRegistry.transition(
+            moduleIdentifier, {ModuleRecord::ConnectionState::Connected, ModuleRecord::ConnectionState::Disconnected},
+            ModuleRecord::ConnectionState::Registered);
+        if (transitionResult == TransitionResult::NotFound) {
             throw ModuleRequestHandlerException(ModuleRequestHandlerException::ErrorCode::Dropped);
-        } else {
-            moduleRecord->connectionState = ModuleRecord::ConnectionState::Registered;
-            auto moduleUpdated = this->modulesCollection.updateModule(std::move(*moduleRecord));
-            if (!moduleUpdated) {
-                Log::error("Unable to update module");
-            }
         }
     }
 }
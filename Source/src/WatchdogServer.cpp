@@ -1,34 +1,86 @@
 #include "WatchdogServer.hpp"
 #include "Logging.hpp"
+#include "MongoDbContext.hpp"
 #include "MongoDbEnvironment.hpp"
 #include <csignal>
+#include <pthread.h>
 #include <exception>
 #include <iostream>
 
 namespace Watchdog {
 
-WatchdogServer::WatchdogServer()
-    : modulesAcceptor{ioContext, modulesCollection, servicesCollection}, servicesAcceptor{ioContext, modulesCollection,
-                                                                                          servicesCollection} {
+namespace {
+
+template <typename ConnectionState> std::string stateLabel(std::string_view kind, ConnectionState state) {
+    std::string label{"kind=\""};
+    label.append(kind).append("\",state=\"");
+    switch (state) {
+    case ConnectionState::Registered:
+        label.append("registered");
+        break;
+    case ConnectionState::Connected:
+        label.append("connected");
+        break;
+    case ConnectionState::Disconnected:
+        label.append("disconnected");
+        break;
+    }
+    return label.append("\"");
+}
+
+std::string shardLabel(size_t shardNr) { return "shard=\"" + std::to_string(shardNr) + "\""; }
+
+} // namespace
+
+WatchdogServer::WatchdogServer(const ServerConfiguration& configuration)
+    : configuration{configuration}, ioContextPool{configuration.ioContextPerThread ? configuration.workingThreads : 1,
+                                                  configuration.connectionsDispatch},
+      modulesWriter{"Modules"}, servicesWriter{"Services"},
+      modulesRegistry{[this](const Types::ModuleIdentifier& identifier) { return this->loadModule(identifier); },
+                      [this](const ModuleRecord& record, Types::RecordField fields) { this->modulesWriter.push(record, fields); }},
+      servicesRegistry{[this](const Types::ServiceIdentifier& identifier) { return this->loadService(identifier); },
+                       [this](const ServiceRecord& record, Types::RecordField fields) { this->servicesWriter.push(record, fields); }},
+      storageExecutor{configuration.storageThreads}, modulesAcceptor{ioContextPool, modulesRegistry, servicesRegistry, storageExecutor},
+      servicesAcceptor{ioContextPool, modulesRegistry, servicesRegistry, storageExecutor},
+      adminAcceptor{[this](Metrics::PrometheusWriter& writer) { this->collectMetrics(writer); }} {
     threadsState.start = false;
 }
 
+std::optional<ModuleRecord> WatchdogServer::loadModule(const Types::ModuleIdentifier& moduleIdentifier) {
+    std::optional<ModuleRecord> moduleRecord{std::nullopt};
+    auto* dbContext = Mongo::DbContext::get();
+    if (!dbContext) {
+        Log::critical("WatchdogServer::loadModule(): Module not cached and thread has no mongodb context");
+    } else {
+        moduleRecord = dbContext->getModulesCollection().getModule(moduleIdentifier);
+    }
+    return moduleRecord;
+}
+
+std::optional<ServiceRecord> WatchdogServer::loadService(const Types::ServiceIdentifier& serviceIdentifier) {
+    std::optional<ServiceRecord> serviceRecord{std::nullopt};
+    auto* dbContext = Mongo::DbContext::get();
+    if (!dbContext) {
+        Log::critical("WatchdogServer::loadService(): Service not cached and thread has no mongodb context");
+    } else {
+        serviceRecord = dbContext->getServicesCollection().getService(serviceIdentifier);
+    }
+    return serviceRecord;
+}
+
 bool WatchdogServer::createWorkingThreads() {
     bool created{true};
     try {
-        for (auto threadNr = 0; threadNr < 3; threadNr++) {
-            extraWorkingThreads.emplace_back([&]() { ioContext.run(); });
+        Log::info("WatchdogServer::createWorkingThreads starting {} threads on {} io_contexts", configuration.workingThreads,
+                  ioContextPool.size());
+        for (size_t threadNr = 0; threadNr < configuration.workingThreads; threadNr++) {
+            auto& shard = ioContextPool.getShard(threadNr);
+            // Working threads do network work only, database is reached through storage executor
+            auto& thread = extraWorkingThreads.emplace_back([&shard]() { shard.ioContext.run(); });
+            if (configuration.pinThreads) {
+                WatchdogServer::pinToCpu(thread, threadNr);
+            }
         }
-        std::for_each(std::begin(extraWorkingThreads), std::end(extraWorkingThreads), [&](auto& thread) {
-            std::thread::id this_id = thread.get_id();
-            auto modulesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
-            Mongo::ModulesCollection modulesCollection{*modulesCollectionEntry, "Modules"};
-            this->modulesCollection.insert({this_id, std::move(modulesCollection)});
-
-            auto servicesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
-            Mongo::ServicesCollection services{*servicesCollectionEntry, "Services"};
-            this->servicesCollection.insert({this_id, std::move(services)});
-        });
     } catch (std::exception& ex) {
         created = false;
     }
@@ -49,12 +101,24 @@ void WatchdogServer::setupSignalHandlers() {
 
 void WatchdogServer::onSignal(int signalNum) { exit(signalNum); }
 
+void WatchdogServer::pinToCpu(std::thread& thread, size_t cpuNr) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpuNr % std::max(1u, std::thread::hardware_concurrency()), &cpuSet);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet) != 0) {
+        Log::error("WatchdogServer::pinToCpu failed to pin thread to cpu {}", cpuNr);
+    }
+}
+
 bool WatchdogServer::startAcceptingConnections() {
     bool acceptingConnections{true};
     try {
         Log::critical("WatchdogServer::startAcceptingConnections modules acceptor start");
         this->modulesAcceptor.startAcceptingConnections();
         this->servicesAcceptor.startAcceptingServices();
+        if (configuration.adminEndpoint && !this->adminAcceptor.start(configuration.adminPort)) {
+            Log::error("WatchdogServer::startAcceptingConnections admin endpoint not started, metrics are not served");
+        }
     } catch (std::exception& ex) {
         Log::critical("WatchdogServer::startAcceptingConnections modules acceptor start failure");
         acceptingConnections = false;
@@ -62,6 +126,34 @@ bool WatchdogServer::startAcceptingConnections() {
     return acceptingConnections;
 }
 
+// Called on admin thread, reads only atomics and briefly locks registry shards
+void WatchdogServer::collectMetrics(Metrics::PrometheusWriter& writer) {
+    for (auto [state, count] : this->modulesRegistry.countByState()) {
+        writer.gauge("watchdog_programs", stateLabel("module", state), static_cast<int64_t>(count));
+    }
+    for (auto [state, count] : this->servicesRegistry.countByState()) {
+        writer.gauge("watchdog_programs", stateLabel("service", state), static_cast<int64_t>(count));
+    }
+    for (size_t shardNr = 0; shardNr < this->ioContextPool.size(); shardNr++) {
+        auto connections = this->ioContextPool.getShard(shardNr).connections.load(std::memory_order_relaxed);
+        writer.gauge("watchdog_shard_connections", shardLabel(shardNr), static_cast<int64_t>(connections));
+    }
+    for (size_t shardNr = 0; shardNr < this->ioContextPool.size(); shardNr++) {
+        auto scheduledTimers = this->ioContextPool.getShard(shardNr).timerWheel.size();
+        writer.gauge("watchdog_shard_scheduled_timers", shardLabel(shardNr), static_cast<int64_t>(scheduledTimers));
+    }
+    for (size_t shardNr = 0; shardNr < this->ioContextPool.size(); shardNr++) {
+        auto loopLag = this->ioContextPool.getShard(shardNr).loopLagNanoseconds.load(std::memory_order_relaxed);
+        writer.gauge("watchdog_shard_loop_lag_nanoseconds", shardLabel(shardNr), loopLag);
+    }
+    // Lag reported above was measured by probe of previous scrape
+    this->ioContextPool.probeLoopLag();
+    if (auto& dbEnvironment = Mongo::DbEnvironment::getInstance()) {
+        writer.gauge("watchdog_mongo_clients_in_use", {}, static_cast<int64_t>(dbEnvironment->getClientsInUse()));
+    }
+    writer.counter("watchdog_log_dropped_messages_total", {}, Log::droppedMessages());
+}
+
 void WatchdogServer::setAllConnectedToDisconnectedState() {
     auto modulesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
     Mongo::ModulesCollection modulesCollection{*modulesCollectionEntry, "Modules"};
@@ -72,4 +164,16 @@ void WatchdogServer::setAllConnectedToDisconnectedState() {
     servicesCollection.markAllConnectedAsDisconnected();
 }
 
+void WatchdogServer::loadRegistries() {
+    auto modulesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
+    Mongo::ModulesCollection modulesCollection{*modulesCollectionEntry, "Modules"};
+    this->modulesRegistry.load(modulesCollection.getAllModules());
+
+    auto servicesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
+    Mongo::ServicesCollection servicesCollection{*servicesCollectionEntry, "Services"};
+    this->servicesRegistry.load(servicesCollection.getAllServices());
+    Log::info("WatchdogServer::loadRegistries loaded {} modules and {} services", this->modulesRegistry.size(),
+              this->servicesRegistry.size());
+}
+
 } // namespace Watchdog
\ No newline at end of file
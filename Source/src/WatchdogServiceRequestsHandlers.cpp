@@ -13,22 +13,30 @@ uint32_t ServiceRequestHandler::generateNewSequenceCode(uint32_t oldSequenceCode
     return newSequenceCode;
 }
 
+void ServiceRequestHandler::setResponseBody(const google::protobuf::MessageLite& response) {
+    size_t responseSize = response.ByteSizeLong();
+    Communication::BufferPool::prepare(this->responseMessage.body, responseSize);
+    response.SerializeToArray(this->responseMessage.body.data(), static_cast<int>(responseSize));
+    this->responseMessage.header.size = responseSize;
+}
+
 ServiceConnectRequestHandler::ServiceConnectRequestHandler(ServiceAuthenticationData& authorizationData,
-                                                           Mongo::ServicesCollection& servicesCollection,
+                                                           ServicesRegistry& servicesRegistry,
                                                            std::function<void()> timerControl)
-    : ServiceRequestHandler{authorizationData}, servicesCollection{servicesCollection}, timerControl{std::move(timerControl)} {
+    : ServiceRequestHandler{authorizationData}, servicesRegistry{servicesRegistry}, timerControl{std::move(timerControl)} {
     this->responseMessage.header.operationCode = WatchdogService::Operation::ConnectResponse;
 }
 
-Communication::Message<WatchdogService::Operation> ServiceConnectRequestHandler::createResponse(std::string& receivedRequest) {
-    if (!this->connectRequestData.ParseFromString(receivedRequest)) {
+Communication::Message<WatchdogService::Operation> ServiceConnectRequestHandler::createResponse(std::string_view receivedRequest) {
+    // Handler is reused for all requests of connection
+    this->connectResponseData.Clear();
+    if (!this->connectRequestData.ParseFromArray(receivedRequest.data(), static_cast<int>(receivedRequest.size()))) {
         Log::error("Failed to parse received service connect request");
         throw ServiceRequestHandlerException{ServiceRequestHandlerException::ErrorCode::FailedToParse};
     }
     this->processConnectRequest();
-    this->connectResponseData.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->connectResponseData);
+    return std::move(this->responseMessage);
 }
 
 void ServiceConnectRequestHandler::processConnectRequest() {
@@ -36,20 +44,19 @@ void ServiceConnectRequestHandler::processConnectRequest() {
         this->connectResponseData.set_responsecode(WatchdogService::NotServiceIdentifier);
     } else {
         const Types::ServiceIdentifier& serviceIdentifier = connectRequestData.identifier();
-        auto serviceRecord = servicesCollection.getService(serviceIdentifier);
-        if (!serviceRecord.has_value()) {
+        auto transitionResult = servicesRegistry.transition(
+            serviceIdentifier, {ServiceRecord::ConnectionState::Registered, ServiceRecord::ConnectionState::Disconnected},
+            ServiceRecord::ConnectionState::Connected);
+        if (transitionResult == TransitionResult::NotFound) {
             this->connectResponseData.set_responsecode(WatchdogService::ServiceNotExists);
-        } else if (serviceRecord->connectionState == ServiceRecord::ConnectionState::Connected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             this->connectResponseData.set_responsecode(WatchdogService::InvalidConnectionState);
         } else {
-            serviceRecord->connectionState = ServiceRecord::ConnectionState::Connected;
             this->authenticationData.identifier = serviceIdentifier;
-            if (this->servicesCollection.updateService(std::move(*serviceRecord))) {
-                this->authenticationData.sequenceCode = this->generateNewSequenceCode();
-                this->connectResponseData.set_responsecode(WatchdogService::Success);
-                this->connectResponseData.set_sequencecode(this->authenticationData.sequenceCode);
-                this->timerControl();
-            }
+            this->authenticationData.sequenceCode = this->generateNewSequenceCode();
+            this->connectResponseData.set_responsecode(WatchdogService::Success);
+            this->connectResponseData.set_sequencecode(this->authenticationData.sequenceCode);
+            this->timerControl();
         }
     }
 }
@@ -59,8 +66,10 @@ ServicePingRequestHandler::ServicePingRequestHandler(ServiceAuthenticationData&
     this->responseMessage.header.operationCode = WatchdogService::Operation::PingResponse;
 }
 
-Communication::Message<WatchdogService::Operation> ServicePingRequestHandler::createResponse(std::string& receivedRequest) {
-    if (!this->pingRequestData.ParseFromString(receivedRequest)) {
+Communication::Message<WatchdogService::Operation> ServicePingRequestHandler::createResponse(std::string_view receivedRequest) {
+    // Handler is reused for all requests of connection
+    this->pingResponseData.Clear();
+    if (!this->pingRequestData.ParseFromArray(receivedRequest.data(), static_cast<int>(receivedRequest.size()))) {
         Log::error("Failed to parse received module ping request");
         throw ServiceRequestHandlerException{ServiceRequestHandlerException::ErrorCode::FailedToParse};
     }
@@ -71,72 +80,68 @@ Communication::Message<WatchdogService::Operation> ServicePingRequestHandler::cr
     } else {
         throw ServiceRequestHandlerException(ServiceRequestHandlerException::ErrorCode::Dropped);
     }
-    this->pingResponseData.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->pingResponseData);
+    return std::move(this->responseMessage);
 }
 
 ServiceReconnectRequestHandler::ServiceReconnectRequestHandler(ServiceAuthenticationData& authorizationData,
-                                                               Mongo::ServicesCollection& servicesCollection,
+                                                               ServicesRegistry& servicesRegistry,
                                                                std::function<void()> timerControl)
-    : ServiceRequestHandler{authorizationData}, servicesCollection{servicesCollection}, timerControl{timerControl} {
+    : ServiceRequestHandler{authorizationData}, servicesRegistry{servicesRegistry}, timerControl{timerControl} {
     this->responseMessage.header.operationCode = WatchdogService::Operation::ReconnectResponse;
 }
 
-Communication::Message<WatchdogService::Operation> ServiceReconnectRequestHandler::createResponse(std::string& receivedRequest) {
-    if (!this->reconnectRequestData.ParseFromString(receivedRequest)) {
+Communication::Message<WatchdogService::Operation> ServiceReconnectRequestHandler::createResponse(std::string_view receivedRequest) {
+    // Handler is reused for all requests of connection
+    this->reconnectResponseData.Clear();
+    if (!this->reconnectRequestData.ParseFromArray(receivedRequest.data(), static_cast<int>(receivedRequest.size()))) {
         Log::error("Failed to parse received service connect request");
         throw ServiceRequestHandlerException{ServiceRequestHandlerException::ErrorCode::FailedToParse};
     }
     this->processReconnectRequest();
-    this->reconnectResponseData.SerializeToString(&responseMessage.body);
-    this->responseMessage.header.size = responseMessage.body.size();
-    return this->responseMessage;
+    this->setResponseBody(this->reconnectResponseData);
+    return std::move(this->responseMessage);
 }
 
 void ServiceReconnectRequestHandler::processReconnectRequest() {
     if (!Types::isServiceIdentifier(reconnectRequestData.identifier())) {
         this->reconnectResponseData.set_responsecode(WatchdogService::NotServiceIdentifier);
     } else {
-        const Types::ServiceIdentifier& moduleIdentifier = reconnectRequestData.identifier();
-        auto serviceRecord = servicesCollection.getService(moduleIdentifier);
-        if (!serviceRecord.has_value()) {
+        const Types::ServiceIdentifier& serviceIdentifier = reconnectRequestData.identifier();
+        auto transitionResult = servicesRegistry.transition(serviceIdentifier, {ServiceRecord::ConnectionState::Disconnected},
+                                                            ServiceRecord::ConnectionState::Connected);
+        if (transitionResult == TransitionResult::NotFound) {
             this->reconnectResponseData.set_responsecode(WatchdogService::ServiceNotExists);
-        } else if (serviceRecord->connectionState != ServiceRecord::ConnectionState::Disconnected) {
+        } else if (transitionResult == TransitionResult::InvalidState) {
             this->reconnectResponseData.set_responsecode(WatchdogService::InvalidConnectionState);
         } else {
-            serviceRecord->connectionState = ServiceRecord::ConnectionState::Connected;
-            if (servicesCollection.updateService(std::move(*serviceRecord))) {
-                this->authenticationData.sequenceCode = this->generateNewSequenceCode(this->authenticationData.sequenceCode);
-                this->reconnectResponseData.set_sequencecode(this->authenticationData.sequenceCode);
-                this->reconnectResponseData.set_responsecode(WatchdogService::Success);
-                this->timerControl();
-            }
+            // Connection may be new one, disconnect must find record it reconnected
+            this->authenticationData.identifier = serviceIdentifier;
+            this->authenticationData.sequenceCode = this->generateNewSequenceCode(this->authenticationData.sequenceCode);
+            this->reconnectResponseData.set_sequencecode(this->authenticationData.sequenceCode);
+            this->reconnectResponseData.set_responsecode(WatchdogService::Success);
+            this->timerControl();
         }
     }
 }
 
 ServiceShutdownRequestHandler::ServiceShutdownRequestHandler(ServiceAuthenticationData& authorizationData,
-                                                             Mongo::ServicesCollection& servicesCollection)
-    : ServiceRequestHandler{authorizationData}, servicesCollection{servicesCollection} {}
+                                                             ServicesRegistry& servicesRegistry)
+    : ServiceRequestHandler{authorizationData}, servicesRegistry{servicesRegistry} {}
 
-Communication::Message<WatchdogService::Operation> ServiceShutdownRequestHandler::createResponse(std::string& receivedRequest) {
-    if (!this->shutdownRequestData.ParseFromString(receivedRequest)) {
+Communication::Message<WatchdogService::Operation> ServiceShutdownRequestHandler::createResponse(std::string_view receivedRequest) {
+    if (!this->shutdownRequestData.ParseFromArray(receivedRequest.data(), static_cast<int>(receivedRequest.size()))) {
         Log::error("Failed to parse received module ping request");
         throw ServiceRequestHandlerException{ServiceRequestHandlerException::ErrorCode::FailedToParse};
     } else if (!Types::isServiceIdentifier(shutdownRequestData.identifier())) {
         throw ServiceRequestHandlerException(ServiceRequestHandlerException::ErrorCode::Dropped);
     } else {
-        const Types::ModuleIdentifier& serviceIdentifier = shutdownRequestData.identifier();
-        auto serviceRecord = servicesCollection.getService(serviceIdentifier);
-        if (!serviceRecord.has_value()) {
+        const Types::ServiceIdentifier& serviceIdentifier = shutdownRequestData.identifier();
+        auto transitionResult = this->servicesRegistry.transition(
+            serviceIdentifier, {ServiceRecord::ConnectionState::Connected, ServiceRecord::ConnectionState::Disconnected},
+            ServiceRecord::ConnectionState::Registered);
+        if (transitionResult == TransitionResult::NotFound) {
             throw ServiceRequestHandlerException(ServiceRequestHandlerException::ErrorCode::Dropped);
-        } else {
-            serviceRecord->connectionState = ServiceRecord::ConnectionState::Registered;
-            auto moduleUpdated = this->servicesCollection.updateService(std::move(*serviceRecord));
-            if (!moduleUpdated) {
-                Log::error("Unable to update module");
-            }
         }
     }
     throw ServiceRequestHandlerException(ServiceRequestHandlerException::ErrorCode::NoResponseRequired);
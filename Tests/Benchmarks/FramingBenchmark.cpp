@@ -0,0 +1,90 @@
+#include "Communication.hpp"
+#include "Connection.hpp"
+#include "TimerWheel.hpp"
+#include "WatchdogModule.pb.h"
+#include <boost/asio.hpp>
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Operation = WatchdogModule::Operation;
+
+// Answers every request with response carrying request body, so only framing and queues are measured
+class EchoConnection : public Connection::TcpConnection<Operation> {
+public:
+    size_t handledRequests{0};
+
+protected:
+    boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<Operation> receivedMessage) override {
+        Communication::Message<Operation> response{};
+        response.header.operationCode = Operation::PingResponse;
+        response.header.size = receivedMessage.header.size;
+        response.body = Communication::BufferPool::acquire(receivedMessage.body.size());
+        std::memcpy(response.body.data(), receivedMessage.body.data(), receivedMessage.body.size());
+        this->sendMessage(std::move(response));
+        this->handledRequests++;
+        co_return;
+    }
+    void onTimerExpiration() override {}
+    bool acceptPing(uint32_t) override { return false; }
+
+public:
+    EchoConnection(boost::asio::io_context& ioContext, Connection::TimerWheel& timerWheel)
+        : Connection::TcpConnection<Operation>{ioContext, timerWheel} {}
+};
+
+// Frames of batchSize ping requests written back to back, as client pipelining pings would send them
+std::vector<char> makeRequestFrames(size_t batchSize) {
+    WatchdogModule::PingRequestData pingRequest{};
+    pingRequest.set_sequencecode(123);
+    auto body = pingRequest.SerializeAsString();
+    Communication::MessageHeader<Operation> header{Operation::PingRequest, static_cast<uint32_t>(body.size())};
+    std::vector<char> frames{};
+    for (size_t frameNr = 0; frameNr < batchSize; frameNr++) {
+        auto headerBytes = reinterpret_cast<const char*>(&header);
+        frames.insert(std::end(frames), headerBytes, headerBytes + sizeof(header));
+        frames.insert(std::end(frames), std::begin(body), std::end(body));
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST_CASE("TcpConnection framing over socketpair", "[Benchmarks][Connection]") {
+    int sockets[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    boost::asio::io_context ioContext{1};
+    Connection::TimerWheel timerWheel{ioContext};
+    auto connection = std::make_shared<EchoConnection>(ioContext, timerWheel);
+    // Stream socket of any family is read and written the same way, watchdog side gets one end of pair
+    connection->getSocket().assign(boost::asio::ip::tcp::v4(), sockets[0]);
+    boost::asio::ip::tcp::socket client{ioContext};
+    client.assign(boost::asio::ip::tcp::v4(), sockets[1]);
+    connection->startReading();
+
+    for (size_t batchSize : {1, 16, 256}) {
+        auto requestFrames = makeRequestFrames(batchSize);
+        // Responses echo request bodies, so they are as long as requests
+        std::vector<char> responseFrames(requestFrames.size());
+
+        BENCHMARK("decode and answer " + std::to_string(batchSize) + " ping frames") {
+            boost::asio::write(client, boost::asio::buffer(requestFrames));
+            size_t receivedBytes{0};
+            while (receivedBytes < responseFrames.size()) {
+                ioContext.poll();
+                if (size_t available = client.available(); available > 0) {
+                    size_t readSize = std::min(available, responseFrames.size() - receivedBytes);
+                    receivedBytes += client.read_some(boost::asio::buffer(responseFrames.data() + receivedBytes, readSize));
+                }
+            }
+            return connection->handledRequests;
+        };
+    }
+
+    connection->disconnect();
+    ioContext.poll();
+}
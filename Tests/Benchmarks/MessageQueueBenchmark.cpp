@@ -0,0 +1,95 @@
+#include "Communication.hpp"
+#include "MessageQueue.hpp"
+#include "MpmcRingBuffer.hpp"
+#include "SpscMessageQueue.hpp"
+#include <catch2/catch.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Message = Communication::Message<WatchdogModule::Operation>;
+
+constexpr size_t MessagesCount{100000};
+
+Message makeMessage() {
+    Message message{};
+    message.header.operationCode = WatchdogModule::Operation::PingResponse;
+    message.header.size = 4;
+    message.body = "ping";
+    return message;
+}
+
+} // namespace
+
+// MessageQueue is confined to connection strand, so it is measured single threaded the way connection uses it
+TEST_CASE("MessageQueue push and pop", "[Benchmarks][MessageQueue]") {
+    MessageQueue<Message> queue{};
+    auto message = makeMessage();
+
+    BENCHMARK("push 64 then pop 64") {
+        for (size_t messageNr = 0; messageNr < 64; messageNr++) {
+            (void)queue.push(message);
+        }
+        queue.pop(64);
+        return queue.size();
+    };
+}
+
+// Queues shared between threads are measured with producers and consumer racing on them. Side which finds queue
+// full or empty yields, so results stay meaningful on machines with fewer cores than threads.
+TEST_CASE("Lock-free queues under contention", "[Benchmarks][MessageQueue]") {
+    auto message = makeMessage();
+
+    BENCHMARK("SpscMessageQueue 1 producer 1 consumer, 100000 messages") {
+        SpscMessageQueue<Message> queue{};
+        std::thread producer([&queue, &message]() {
+            for (size_t messageNr = 0; messageNr < MessagesCount;) {
+                if (queue.push(message) > 0) {
+                    messageNr++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        size_t consumed{0};
+        while (consumed < MessagesCount) {
+            size_t available = queue.peek(64, [](const Message&) {});
+            if (available == 0) {
+                std::this_thread::yield();
+            }
+            queue.pop(available);
+            consumed += available;
+        }
+        producer.join();
+        return consumed;
+    };
+
+    for (size_t producersCount : {2, 4}) {
+        BENCHMARK("MpmcRingBuffer " + std::to_string(producersCount) + " producers 1 consumer, 100000 messages") {
+            MpmcRingBuffer<Message> queue{1024};
+            std::vector<std::thread> producers{};
+            for (size_t producerNr = 0; producerNr < producersCount; producerNr++) {
+                producers.emplace_back([&queue, &message, producersCount]() {
+                    for (size_t messageNr = 0; messageNr < MessagesCount / producersCount;) {
+                        if (queue.tryPush([&message](Message& slot) { slot = message; })) {
+                            messageNr++;
+                        } else {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            size_t consumed{0};
+            while (consumed < MessagesCount / producersCount * producersCount) {
+                if (queue.tryPop([](Message&) {})) {
+                    consumed++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            std::for_each(std::begin(producers), std::end(producers), std::mem_fn(&std::thread::join));
+            return consumed;
+        };
+    }
+}
@@ -0,0 +1,17 @@
+#include "MongoModulesCollection.hpp"
+#include "Types.hpp"
+#include <catch2/catch.hpp>
+
+TEST_CASE("Module record BSON conversions", "[Benchmarks][MongoDatabase]") {
+    ModuleRecord record{};
+    record.identifier = Types::toModuleIdentifier(1);
+    record.connectionState = ModuleRecord::ConnectionState::Connected;
+    record.ipAddress = "192.168.100.100";
+    record.port = 5000;
+    auto document = Mongo::ModulesCollection::moduleRecordToDocument(record);
+    REQUIRE(Mongo::ModulesCollection::viewToModuleRecord(document.view()).has_value());
+
+    BENCHMARK("moduleRecordToDocument") { return Mongo::ModulesCollection::moduleRecordToDocument(record); };
+
+    BENCHMARK("viewToModuleRecord") { return Mongo::ModulesCollection::viewToModuleRecord(document.view()); };
+}
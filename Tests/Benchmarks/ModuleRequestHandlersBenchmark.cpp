@@ -0,0 +1,86 @@
+#include "BufferPool.hpp"
+#include "ProgramRegistry.hpp"
+#include "Types.hpp"
+#include "WatchdogModule.pb.h"
+#include "WatchdogModuleRequestsHandlers.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Registry without database: nothing is loaded on cache miss and nothing is persisted
+Watchdog::ModulesRegistry makeInMemoryRegistry() {
+    return Watchdog::ModulesRegistry{[](const Types::ModuleIdentifier&) { return std::optional<ModuleRecord>{}; },
+                                     [](const ModuleRecord&, Types::RecordField) {}};
+}
+
+// Registers one module per benchmark run, every run changes state of its own module
+void loadModules(Watchdog::ModulesRegistry& registry, size_t count, ModuleRecord::ConnectionState state) {
+    std::vector<ModuleRecord> records(count);
+    for (size_t moduleNr = 0; moduleNr < count; moduleNr++) {
+        records[moduleNr].identifier = Types::toModuleIdentifier(static_cast<Types::Identifier>(moduleNr));
+        records[moduleNr].connectionState = state;
+        records[moduleNr].ipAddress = "127.0.0.1";
+    }
+    registry.load(std::move(records));
+}
+
+template <typename Request> std::vector<std::string> makeIdentifierRequests(size_t count) {
+    std::vector<std::string> requests(count);
+    Request request{};
+    for (size_t moduleNr = 0; moduleNr < count; moduleNr++) {
+        request.set_identifier(Types::toModuleIdentifier(static_cast<Types::Identifier>(moduleNr)));
+        request.SerializeToString(&requests[moduleNr]);
+    }
+    return requests;
+}
+
+// Response body is taken from buffer pool, connection returns it there once response is sent
+void releaseResponse(Communication::Message<WatchdogModule::Operation>&& response) {
+    Communication::BufferPool::release(std::move(response.body));
+}
+
+} // namespace
+
+TEST_CASE("Module request handlers createResponse", "[Benchmarks][WatchdogModuleRequestsHandlers]") {
+    auto registry = makeInMemoryRegistry();
+    Watchdog::ModuleAuthenticationData authenticationData{};
+    auto timerControl = []() {};
+
+    BENCHMARK_ADVANCED("ModuleConnectRequestHandler")(Catch::Benchmark::Chronometer meter) {
+        loadModules(registry, static_cast<size_t>(meter.runs()), ModuleRecord::ConnectionState::Registered);
+        auto requests = makeIdentifierRequests<WatchdogModule::ConnectRequestData>(static_cast<size_t>(meter.runs()));
+        Watchdog::ModuleConnectRequestHandler handler{authenticationData, registry, timerControl};
+        meter.measure([&](int run) { releaseResponse(handler.createResponse(requests[run])); });
+    };
+
+    BENCHMARK_ADVANCED("ModulePingRequestHandler")(Catch::Benchmark::Chronometer meter) {
+        authenticationData.sequenceCode = 7;
+        WatchdogModule::PingRequestData pingRequest{};
+        pingRequest.set_sequencecode(7);
+        auto request = pingRequest.SerializeAsString();
+        Watchdog::ModulePingRequestHandler handler{authenticationData, timerControl};
+        meter.measure([&]() { releaseResponse(handler.createResponse(request)); });
+    };
+
+    BENCHMARK_ADVANCED("ModuleReconnectRequestHandler")(Catch::Benchmark::Chronometer meter) {
+        loadModules(registry, static_cast<size_t>(meter.runs()), ModuleRecord::ConnectionState::Disconnected);
+        auto requests = makeIdentifierRequests<WatchdogModule::ReconnectRequestData>(static_cast<size_t>(meter.runs()));
+        Watchdog::ModuleReconnectRequestHandler handler{authenticationData, registry, timerControl};
+        meter.measure([&](int run) { releaseResponse(handler.createResponse(requests[run])); });
+    };
+
+    BENCHMARK_ADVANCED("ModuleShutdownRequestHandler")(Catch::Benchmark::Chronometer meter) {
+        loadModules(registry, static_cast<size_t>(meter.runs()), ModuleRecord::ConnectionState::Connected);
+        auto requests = makeIdentifierRequests<WatchdogModule::ShutdownRequestData>(static_cast<size_t>(meter.runs()));
+        Watchdog::ModuleShutdownRequestHandler handler{authenticationData, registry};
+        // Shutdown is never answered, handler signals it with exception
+        meter.measure([&](int run) {
+            try {
+                releaseResponse(handler.createResponse(requests[run]));
+            } catch (Watchdog::ModuleRequestHandlerException&) {
+            }
+        });
+    };
+}
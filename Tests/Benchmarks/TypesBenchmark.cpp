@@ -0,0 +1,46 @@
+#include "Types.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+TEST_CASE("Identifiers classification", "[Benchmarks][Types]") {
+    // Mix of module, service and foreign identifiers, as seen in requests
+    std::vector<Types::Identifier> identifiers{};
+    identifiers.reserve(1024);
+    for (Types::Identifier number = 0; number < 1024; number++) {
+        switch (number % 3) {
+        case 0:
+            identifiers.push_back(Types::toModuleIdentifier(number));
+            break;
+        case 1:
+            identifiers.push_back(Types::toServiceIdentifier(number));
+            break;
+        default:
+            identifiers.push_back(number);
+            break;
+        }
+    }
+
+    BENCHMARK("isModuleIdentifier x1024") {
+        size_t modules{0};
+        for (auto identifier : identifiers) {
+            modules += Types::isModuleIdentifier(identifier) ? 1 : 0;
+        }
+        return modules;
+    };
+
+    BENCHMARK("isServiceIdentifier x1024") {
+        size_t services{0};
+        for (auto identifier : identifiers) {
+            services += Types::isServiceIdentifier(identifier) ? 1 : 0;
+        }
+        return services;
+    };
+
+    BENCHMARK("toModuleIdentifier x1024") {
+        Types::Identifier checksum{0};
+        for (Types::Identifier number = 0; number < 1024; number++) {
+            checksum ^= Types::toModuleIdentifier(number);
+        }
+        return checksum;
+    };
+}
@@ -0,0 +1,80 @@
+#include "BufferPool.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+
+using Communication::BufferPool;
+
+TEST_CASE("BufferPool serves buffers from buckets", "[ConnectionTests][BufferPool]") {
+    SECTION("Acquired buffer has requested size and capacity of smallest fitting bucket") {
+        auto small = BufferPool::acquire(10);
+        REQUIRE(small.size() == 10);
+        REQUIRE(small.capacity() >= 64);
+        auto medium = BufferPool::acquire(300);
+        REQUIRE(medium.size() == 300);
+        REQUIRE(medium.capacity() >= 1024);
+        REQUIRE(medium.capacity() < 4096);
+        BufferPool::release(std::move(small));
+        BufferPool::release(std::move(medium));
+    }
+
+    SECTION("Released buffer is reused by next acquire of its bucket") {
+        auto buffer = BufferPool::acquire(200);
+        const char* data = buffer.data();
+        BufferPool::release(std::move(buffer));
+        auto reused = BufferPool::acquire(150);
+        REQUIRE(reused.data() == data);
+        REQUIRE(reused.size() == 150);
+        BufferPool::release(std::move(reused));
+    }
+
+    SECTION("Released buffer joins biggest bucket it is able to serve") {
+        std::string buffer{};
+        buffer.reserve(500);
+        const char* data = buffer.data();
+        BufferPool::release(std::move(buffer));
+        // 500 bytes are too few for 1024 bucket, buffer serves requests of 256 bucket
+        auto tooBig = BufferPool::acquire(600);
+        REQUIRE(tooBig.data() != data);
+        auto fitting = BufferPool::acquire(256);
+        REQUIRE(fitting.data() == data);
+        BufferPool::release(std::move(tooBig));
+        BufferPool::release(std::move(fitting));
+    }
+
+    SECTION("Buffer bigger than biggest bucket is freed instead of pooled") {
+        auto buffer = BufferPool::acquire(100000);
+        REQUIRE(buffer.size() == 100000);
+        BufferPool::release(std::move(buffer));
+        auto biggest = BufferPool::acquire(4096);
+        REQUIRE(biggest.capacity() < 100000);
+        BufferPool::release(std::move(biggest));
+    }
+
+    SECTION("Prepare keeps buffer which is big enough") {
+        auto buffer = BufferPool::acquire(64);
+        const char* data = buffer.data();
+        BufferPool::prepare(buffer, 32);
+        REQUIRE(buffer.data() == data);
+        REQUIRE(buffer.size() == 32);
+        BufferPool::prepare(buffer, 2000);
+        REQUIRE(buffer.size() == 2000);
+        REQUIRE(buffer.capacity() >= 4096);
+        BufferPool::release(std::move(buffer));
+    }
+
+    SECTION("Buffer released on other thread joins pool of releasing thread") {
+        auto buffer = BufferPool::acquire(1000);
+        const char* data = buffer.data();
+        bool reusedOnReleasingThread{false};
+        std::thread releasingThread{[&]() {
+            BufferPool::release(std::move(buffer));
+            auto reused = BufferPool::acquire(1000);
+            reusedOnReleasingThread = reused.data() == data;
+            // Pool of releasing thread frees buffer once thread exits
+            BufferPool::release(std::move(reused));
+        }};
+        releasingThread.join();
+        REQUIRE(reusedOnReleasingThread);
+    }
+}
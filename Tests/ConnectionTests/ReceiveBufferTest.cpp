@@ -0,0 +1,65 @@
+#include "ReceiveBuffer.hpp"
+#include <boost/asio.hpp>
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+// Copies bytes into receive buffer the way socket read does
+void receive(Connection::ReceiveBuffer& receiveBuffer, std::string_view bytes, size_t minimumSize) {
+    auto space = receiveBuffer.prepare(minimumSize);
+    REQUIRE(space.size() >= bytes.size());
+    std::memcpy(space.data(), bytes.data(), bytes.size());
+    receiveBuffer.commit(bytes.size());
+}
+
+} // namespace
+
+TEST_CASE("ReceiveBuffer keeps unread bytes across reads", "[ConnectionTests][ReceiveBuffer]") {
+    Connection::ReceiveBuffer receiveBuffer{16};
+
+    SECTION("Prepared space is at least requested size") {
+        REQUIRE(receiveBuffer.prepare(8).size() >= 8);
+        REQUIRE(receiveBuffer.prepare(64).size() >= 64);
+        REQUIRE(receiveBuffer.size() == 0);
+    }
+
+    SECTION("Committed bytes are read from front and consumed") {
+        receive(receiveBuffer, "headerbody", 8);
+        REQUIRE(receiveBuffer.data() == "headerbody");
+        receiveBuffer.consume(6);
+        REQUIRE(receiveBuffer.data() == "body");
+        receive(receiveBuffer, "next", 4);
+        REQUIRE(receiveBuffer.data() == "bodynext");
+    }
+
+    SECTION("Consuming all bytes rewinds buffer") {
+        receive(receiveBuffer, "0123456789", 10);
+        const char* start = receiveBuffer.data().data();
+        receiveBuffer.consume(10);
+        REQUIRE(receiveBuffer.size() == 0);
+        receive(receiveBuffer, "abc", 3);
+        REQUIRE(receiveBuffer.data().data() == start);
+    }
+
+    SECTION("Unread tail is moved to beginning when space runs out") {
+        receive(receiveBuffer, "0123456789abcd", 14);
+        const char* start = receiveBuffer.data().data();
+        receiveBuffer.consume(10);
+        // Two bytes are left behind write position, tail is compacted instead of growing buffer
+        auto space = receiveBuffer.prepare(8);
+        REQUIRE(space.size() >= 8);
+        REQUIRE(receiveBuffer.data().data() == start);
+        REQUIRE(receiveBuffer.data() == "abcd");
+        receive(receiveBuffer, "efgh", 4);
+        REQUIRE(receiveBuffer.data() == "abcdefgh");
+    }
+
+    SECTION("Buffer grows when unread bytes and next read do not fit") {
+        receive(receiveBuffer, "0123456789abcd", 14);
+        receiveBuffer.consume(2);
+        receive(receiveBuffer, std::string_view{"efghijklmnopqrstuvwxyz"}, 22);
+        REQUIRE(receiveBuffer.data() == "23456789abcdefghijklmnopqrstuvwxyz");
+    }
+}
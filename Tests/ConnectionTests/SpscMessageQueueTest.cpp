@@ -0,0 +1,80 @@
+#include "SpscMessageQueue.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SpscMessageQueue bounded ring", "[ConnectionTests][SpscMessageQueue]") {
+    SpscMessageQueue<std::string, 4> queue{};
+
+    SECTION("Empty queue has nothing to peek or pop") {
+        REQUIRE(queue.empty());
+        REQUIRE_FALSE(queue.full());
+        REQUIRE(queue.peek(4, [](const std::string&) {}) == 0);
+        queue.pop(2);
+        REQUIRE(queue.size() == 0);
+    }
+
+    SECTION("Push returns number of queued messages until queue is full") {
+        REQUIRE(queue.push("first") == 1);
+        REQUIRE(queue.push("second") == 2);
+        REQUIRE(queue.push("third") == 3);
+        REQUIRE(queue.push("fourth") == 4);
+        REQUIRE(queue.full());
+        REQUIRE(queue.push("fifth") == 0);
+        REQUIRE(queue.size() == 4);
+        REQUIRE(queue.front() == "first");
+
+        queue.pop();
+        REQUIRE_FALSE(queue.full());
+        REQUIRE(queue.push("fifth") == 4);
+    }
+
+    SECTION("Messages keep order when ring wraps around") {
+        std::vector<std::string> received{};
+        for (size_t messageNr = 0; messageNr < 10; messageNr++) {
+            REQUIRE(queue.push(std::to_string(messageNr)) > 0);
+            if (messageNr % 2 == 1) {
+                // Queue never holds more than two messages, while its head and tail pass end of ring several times
+                queue.pop(2, [&received](std::string& message) { received.push_back(std::move(message)); });
+            }
+        }
+        REQUIRE(queue.empty());
+        REQUIRE(received == std::vector<std::string>{"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"});
+    }
+
+    SECTION("Peek visits messages from front without removing them") {
+        (void)queue.push("first");
+        (void)queue.push("second");
+        (void)queue.push("third");
+        std::vector<std::string> visited{};
+        REQUIRE(queue.peek(2, [&visited](const std::string& message) { visited.push_back(message); }) == 2);
+        REQUIRE(visited == std::vector<std::string>{"first", "second"});
+        REQUIRE(queue.size() == 3);
+    }
+
+    SECTION("Consumer thread receives all messages of producer thread in order") {
+        constexpr size_t MessagesCount{10000};
+        std::thread producer{[&queue]() {
+            for (size_t messageNr = 0; messageNr < MessagesCount; messageNr++) {
+                while (queue.push(std::to_string(messageNr)) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+        size_t expected{0};
+        bool ordered{true};
+        while (expected < MessagesCount) {
+            if (queue.empty()) {
+                std::this_thread::yield();
+            } else {
+                ordered = ordered && queue.front() == std::to_string(expected);
+                queue.pop();
+                expected++;
+            }
+        }
+        producer.join();
+        REQUIRE(ordered);
+        REQUIRE(queue.empty());
+    }
+}
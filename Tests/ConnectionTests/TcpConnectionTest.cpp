@@ -0,0 +1,325 @@
+#include "Communication.hpp"
+#include "Connection.hpp"
+#include "SpscMessageQueue.hpp"
+#include "TimerWheel.hpp"
+#include "WatchdogModule.pb.h"
+#include <boost/asio.hpp>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstring>
+#include <sys/socket.h>
+#include <vector>
+
+namespace {
+
+using Operation = WatchdogModule::Operation;
+using Header = Communication::MessageHeader<Operation>;
+using Clock = std::chrono::steady_clock;
+
+// Answers every request with its own body, or with response of responseSize bytes when it is set.
+// Connect request with body "accept" is accepted, so compact pings it asked for are enabled.
+// While requests are held, handler waits until test releases them.
+class TestConnection : public Connection::TcpConnection<Operation, SpscMessageQueue<Communication::Message<Operation>>> {
+public:
+    size_t responseSize{0};
+    size_t handledRequests{0};
+    std::vector<std::string> receivedBodies{};
+    bool holdRequests{false};
+    boost::asio::steady_timer requestsGate;
+
+    void releaseRequests() {
+        this->holdRequests = false;
+        this->requestsGate.cancel();
+    }
+    [[nodiscard]] size_t pendingRequestsCount() const { return this->pendingRequests.size(); }
+    [[nodiscard]] bool isReadingPaused() const { return this->readingPaused; }
+
+protected:
+    boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<Operation> receivedMessage) override {
+        if (this->holdRequests) {
+            this->requestsGate.expires_at(boost::asio::steady_timer::time_point::max());
+            boost::system::error_code error{};
+            co_await this->requestsGate.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        }
+        Communication::Message<Operation> response{};
+        response.header.operationCode = Operation::PingResponse;
+        if (receivedMessage.header.operationCode == Operation::ConnectRequest) {
+            response.header.operationCode = Operation::ConnectResponse;
+            if (receivedMessage.body == "accept") {
+                this->enableRequestedCompactPings();
+            }
+        }
+        if (this->responseSize == 0) {
+            response.body = Communication::BufferPool::acquire(receivedMessage.body.size());
+            std::memcpy(response.body.data(), receivedMessage.body.data(), receivedMessage.body.size());
+        } else {
+            response.body = Communication::BufferPool::acquire(this->responseSize);
+        }
+        response.header.size = static_cast<uint32_t>(response.body.size());
+        this->receivedBodies.emplace_back(receivedMessage.body);
+        this->sendMessage(std::move(response));
+        this->handledRequests++;
+        co_return;
+    }
+    void onTimerExpiration() override {}
+    bool acceptPing(uint32_t) override { return true; }
+
+public:
+    TestConnection(boost::asio::io_context& ioContext, Connection::TimerWheel& timerWheel)
+        : Connection::TcpConnection<Operation, SpscMessageQueue<Communication::Message<Operation>>>{ioContext, timerWheel},
+          requestsGate{ioContext} {}
+};
+
+// Watchdog side of connection and client socket joined by socket pair
+struct ConnectedPair {
+    boost::asio::io_context ioContext{1};
+    Connection::TimerWheel timerWheel{ioContext};
+    std::shared_ptr<TestConnection> connection{std::make_shared<TestConnection>(ioContext, timerWheel)};
+    boost::asio::ip::tcp::socket client{ioContext};
+
+    ConnectedPair() {
+        int sockets[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+        connection->getSocket().assign(boost::asio::ip::tcp::v4(), sockets[0]);
+        client.assign(boost::asio::ip::tcp::v4(), sockets[1]);
+    }
+    ~ConnectedPair() {
+        connection->disconnect();
+        ioContext.poll();
+    }
+};
+
+void appendFrame(std::vector<char>& frames, Operation operation, const std::string& body) {
+    Header header{operation, static_cast<uint32_t>(body.size())};
+    auto headerBytes = reinterpret_cast<const char*>(&header);
+    frames.insert(std::end(frames), headerBytes, headerBytes + sizeof(header));
+    frames.insert(std::end(frames), std::begin(body), std::end(body));
+}
+
+// Runs connection until condition is met or time limit passes
+template <typename Condition> bool pollUntil(ConnectedPair& pair, Condition&& condition) {
+    auto end = Clock::now() + std::chrono::seconds{2};
+    while (!condition() && Clock::now() < end) {
+        pair.ioContext.poll();
+    }
+    return condition();
+}
+
+// Gives connection chance to handle everything it already received
+void pollFor(ConnectedPair& pair, std::chrono::milliseconds duration) {
+    auto end = Clock::now() + duration;
+    while (Clock::now() < end) {
+        pair.ioContext.poll();
+    }
+}
+
+bool isCompactPingResponse(const Header& header) {
+    return static_cast<uint32_t>(header.operationCode) == (Operation::PingResponse | Communication::CompactFrameFlag);
+}
+
+// Reads responses while running connection, returns every complete response received before time limit
+std::vector<Communication::Message<Operation>> readResponses(ConnectedPair& pair, size_t expectedCount) {
+    std::vector<Communication::Message<Operation>> responses{};
+    std::vector<char> received{};
+    auto end = Clock::now() + std::chrono::seconds{5};
+    while (responses.size() < expectedCount && Clock::now() < end) {
+        pair.ioContext.poll();
+        if (size_t available = pair.client.available(); available > 0) {
+            size_t receivedSize = received.size();
+            received.resize(receivedSize + available);
+            pair.client.read_some(boost::asio::buffer(received.data() + receivedSize, available));
+        }
+        Header header{};
+        while (received.size() >= sizeof(header)) {
+            std::memcpy(&header, received.data(), sizeof(header));
+            // Size of compact ping response carries sequence code, frame has no body
+            size_t bodySize = isCompactPingResponse(header) ? 0 : header.size;
+            if (received.size() < sizeof(header) + bodySize) {
+                break;
+            }
+            responses.push_back(Communication::Message<Operation>{header, std::string(received.data() + sizeof(header), bodySize)});
+            received.erase(std::begin(received), std::next(std::begin(received), sizeof(header) + bodySize));
+        }
+    }
+    return responses;
+}
+
+} // namespace
+
+TEST_CASE("TcpConnection applies backpressure when outgoing queue is full", "[ConnectionTests][TcpConnection]") {
+    ConnectedPair pair{};
+    // Responses are much bigger than socket buffers, so most of them wait in outgoing queue of 256 messages
+    pair.connection->responseSize = 64 * 1024;
+    constexpr size_t RequestsCount{600};
+    std::vector<char> frames{};
+    for (size_t requestNr = 0; requestNr < RequestsCount; requestNr++) {
+        appendFrame(frames, Operation::PingRequest, "ping");
+    }
+    boost::asio::write(pair.client, boost::asio::buffer(frames));
+    pair.connection->startReading();
+
+    // Client does not read, connection stops handling requests instead of dropping responses
+    for (size_t round = 0; round < 100; round++) {
+        pair.ioContext.poll();
+    }
+    REQUIRE(pair.connection->handledRequests < RequestsCount);
+
+    auto responses = readResponses(pair, RequestsCount);
+    REQUIRE(responses.size() == RequestsCount);
+    REQUIRE(pair.connection->handledRequests == RequestsCount);
+}
+
+TEST_CASE("TcpConnection decodes frames split across reads", "[ConnectionTests][TcpConnection]") {
+    ConnectedPair pair{};
+    pair.connection->startReading();
+    std::vector<char> frames{};
+    appendFrame(frames, Operation::PingRequest, "first");
+    appendFrame(frames, Operation::PingRequest, "second");
+
+    SECTION("Partial header waits for its rest") {
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data(), sizeof(Header) - 3));
+        pollFor(pair, std::chrono::milliseconds{20});
+        REQUIRE(pair.connection->receivedBodies.empty());
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data() + sizeof(Header) - 3, frames.size() - sizeof(Header) + 3));
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->receivedBodies.size() == 2; }));
+        REQUIRE(pair.connection->receivedBodies == std::vector<std::string>{"first", "second"});
+    }
+
+    SECTION("Body split between reads is joined") {
+        size_t firstPart = sizeof(Header) + 2;
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data(), firstPart));
+        pollFor(pair, std::chrono::milliseconds{20});
+        REQUIRE(pair.connection->receivedBodies.empty());
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data() + firstPart, frames.size() - firstPart));
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->receivedBodies.size() == 2; }));
+        REQUIRE(pair.connection->receivedBodies == std::vector<std::string>{"first", "second"});
+    }
+
+    SECTION("Complete frames are handled while next frame is still incomplete") {
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data(), frames.size() - 1));
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->receivedBodies.size() == 1; }));
+        pollFor(pair, std::chrono::milliseconds{20});
+        REQUIRE(pair.connection->receivedBodies.size() == 1);
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data() + frames.size() - 1, 1));
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->receivedBodies.size() == 2; }));
+        REQUIRE(pair.connection->receivedBodies.back() == "second");
+    }
+
+    SECTION("Body bigger than read chunk is received whole") {
+        std::string bigBody(10000, 'x');
+        bigBody.back() = 'y';
+        std::vector<char> bigFrames{};
+        appendFrame(bigFrames, Operation::PingRequest, "small");
+        appendFrame(bigFrames, Operation::PingRequest, bigBody);
+        // Small frame is consumed first, rest of big frame is received behind its unread beginning
+        for (size_t offset = 0; offset < bigFrames.size(); offset += 3000) {
+            size_t partSize = std::min<size_t>(3000, bigFrames.size() - offset);
+            boost::asio::write(pair.client, boost::asio::buffer(bigFrames.data() + offset, partSize));
+            pollFor(pair, std::chrono::milliseconds{5});
+        }
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->receivedBodies.size() == 2; }));
+        REQUIRE(pair.connection->receivedBodies.front() == "small");
+        REQUIRE(pair.connection->receivedBodies.back() == bigBody);
+    }
+}
+
+TEST_CASE("TcpConnection closes stream with invalid body size", "[ConnectionTests][TcpConnection]") {
+    ConnectedPair pair{};
+    pair.connection->startReading();
+    uint32_t bodySize = GENERATE(0u, 1024u * 1024u + 1u);
+    Header header{Operation::PingRequest, bodySize};
+    boost::asio::write(pair.client, boost::asio::buffer(&header, sizeof(header)));
+    REQUIRE(pollUntil(pair, [&pair]() { return !pair.connection->getSocket().is_open(); }));
+    REQUIRE(pair.connection->receivedBodies.empty());
+}
+
+TEST_CASE("TcpConnection negotiates compact pings", "[ConnectionTests][TcpConnection]") {
+    ConnectedPair pair{};
+    pair.connection->startReading();
+    auto compactConnect = static_cast<Operation>(Operation::ConnectRequest | Communication::CompactFrameFlag);
+    Header compactPing{static_cast<Operation>(Operation::PingRequest | Communication::CompactFrameFlag), 77};
+
+    SECTION("Accepted connect echoes flag and compact ping is answered with compact frame") {
+        std::vector<char> frames{};
+        appendFrame(frames, compactConnect, "accept");
+        boost::asio::write(pair.client, boost::asio::buffer(frames));
+        auto connectResponses = readResponses(pair, 1);
+        REQUIRE(connectResponses.size() == 1);
+        REQUIRE(static_cast<uint32_t>(connectResponses[0].header.operationCode) ==
+                (Operation::ConnectResponse | Communication::CompactFrameFlag));
+        // Handler saw operation without flag
+        REQUIRE(pair.connection->receivedBodies == std::vector<std::string>{"accept"});
+
+        boost::asio::write(pair.client, boost::asio::buffer(&compactPing, sizeof(compactPing)));
+        auto pingResponses = readResponses(pair, 1);
+        REQUIRE(pingResponses.size() == 1);
+        REQUIRE(isCompactPingResponse(pingResponses[0].header));
+        REQUIRE(pingResponses[0].header.size == 77);
+        REQUIRE(pair.connection->receivedBodies.size() == 1);
+    }
+
+    SECTION("Rejected connect does not enable compact pings") {
+        std::vector<char> frames{};
+        appendFrame(frames, compactConnect, "reject");
+        boost::asio::write(pair.client, boost::asio::buffer(frames));
+        auto connectResponses = readResponses(pair, 1);
+        REQUIRE(connectResponses.size() == 1);
+        REQUIRE(connectResponses[0].header.operationCode == Operation::ConnectResponse);
+
+        boost::asio::write(pair.client, boost::asio::buffer(&compactPing, sizeof(compactPing)));
+        REQUIRE(pollUntil(pair, [&pair]() { return !pair.connection->getSocket().is_open(); }));
+    }
+
+    SECTION("Connect without flag does not enable compact pings") {
+        std::vector<char> frames{};
+        appendFrame(frames, Operation::ConnectRequest, "accept");
+        boost::asio::write(pair.client, boost::asio::buffer(frames));
+        auto connectResponses = readResponses(pair, 1);
+        REQUIRE(connectResponses.size() == 1);
+        REQUIRE(connectResponses[0].header.operationCode == Operation::ConnectResponse);
+
+        boost::asio::write(pair.client, boost::asio::buffer(&compactPing, sizeof(compactPing)));
+        REQUIRE(pollUntil(pair, [&pair]() { return !pair.connection->getSocket().is_open(); }));
+    }
+}
+
+TEST_CASE("TcpConnection pipelines requests", "[ConnectionTests][TcpConnection]") {
+    ConnectedPair pair{};
+    pair.connection->startReading();
+    constexpr size_t RequestsCount{100};
+    std::vector<char> frames{};
+    std::vector<std::string> requestBodies{};
+    for (size_t requestNr = 0; requestNr < RequestsCount; requestNr++) {
+        requestBodies.push_back("request " + std::to_string(requestNr));
+        appendFrame(frames, Operation::PingRequest, requestBodies.back());
+    }
+
+    SECTION("Frames received in one read are answered in request order") {
+        boost::asio::write(pair.client, boost::asio::buffer(frames.data(), frames.size() / RequestsCount * 10));
+        auto responses = readResponses(pair, 10);
+        REQUIRE(responses.size() == 10);
+        for (size_t responseNr = 0; responseNr < responses.size(); responseNr++) {
+            REQUIRE(responses[responseNr].body == requestBodies[responseNr]);
+        }
+    }
+
+    SECTION("Reading pauses once requests in flight reach limit") {
+        pair.connection->holdRequests = true;
+        boost::asio::write(pair.client, boost::asio::buffer(frames));
+        REQUIRE(pollUntil(pair, [&pair]() { return pair.connection->isReadingPaused(); }));
+        pollFor(pair, std::chrono::milliseconds{20});
+        // Held request stays at front of pending requests, with requests behind it they reach in flight limit of 32
+        REQUIRE(pair.connection->pendingRequestsCount() == 32);
+        REQUIRE(pair.connection->handledRequests == 0);
+
+        pair.connection->releaseRequests();
+        auto responses = readResponses(pair, RequestsCount);
+        REQUIRE(responses.size() == RequestsCount);
+        bool ordered{true};
+        for (size_t responseNr = 0; responseNr < responses.size(); responseNr++) {
+            ordered = ordered && responses[responseNr].body == requestBodies[responseNr];
+        }
+        REQUIRE(ordered);
+        REQUIRE_FALSE(pair.connection->isReadingPaused());
+    }
+}
@@ -0,0 +1,106 @@
+#include "TimerWheel.hpp"
+#include <atomic>
+#include <boost/asio.hpp>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Runs io_context until timer expires or limit passes, returns time of expiration
+std::optional<Clock::time_point> runUntilExpired(boost::asio::io_context& ioContext, const std::optional<Clock::time_point>& expiredAt,
+                                                 std::chrono::milliseconds limit) {
+    auto end = Clock::now() + limit;
+    while (!expiredAt.has_value() && Clock::now() < end) {
+        ioContext.run_one_for(std::chrono::milliseconds{5});
+    }
+    return expiredAt;
+}
+
+} // namespace
+
+TEST_CASE("Timer wheel expires and cancels timers", "[ConnectionTests][TimerWheel]") {
+    boost::asio::io_context ioContext{1};
+    Connection::TimerWheel timerWheel{ioContext, std::chrono::milliseconds{10}, 8};
+    std::optional<Clock::time_point> expiredAt{};
+    Connection::TimerWheel::Timer timer{};
+    auto onExpiration = [&expiredAt]() { expiredAt = Clock::now(); };
+    timerWheel.start();
+
+    SECTION("Timer expires not earlier than after timeout") {
+        auto scheduledAt = Clock::now();
+        timerWheel.schedule(timer, std::chrono::milliseconds{30}, onExpiration);
+        REQUIRE(timer.isScheduled());
+        REQUIRE(timerWheel.size() == 1);
+        REQUIRE(runUntilExpired(ioContext, expiredAt, std::chrono::seconds{1}).has_value());
+        REQUIRE(*expiredAt - scheduledAt >= std::chrono::milliseconds{30});
+        REQUIRE_FALSE(timer.isScheduled());
+        REQUIRE(timerWheel.size() == 0);
+    }
+
+    SECTION("Cancelled timer does not expire") {
+        timerWheel.schedule(timer, std::chrono::milliseconds{20}, onExpiration);
+        timerWheel.cancel(timer);
+        REQUIRE_FALSE(timer.isScheduled());
+        REQUIRE(timerWheel.size() == 0);
+        REQUIRE_FALSE(runUntilExpired(ioContext, expiredAt, std::chrono::milliseconds{100}).has_value());
+    }
+
+    SECTION("Rescheduled timer expires once after latest timeout") {
+        size_t firstExpirations{0};
+        size_t expirations{0};
+        timerWheel.schedule(timer, std::chrono::milliseconds{10}, [&]() { firstExpirations++; });
+        auto rescheduledAt = Clock::now();
+        // Rescheduling replaces handler too
+        timerWheel.schedule(timer, std::chrono::milliseconds{50}, [&]() {
+            expirations++;
+            expiredAt = Clock::now();
+        });
+        REQUIRE(timerWheel.size() == 1);
+        REQUIRE(runUntilExpired(ioContext, expiredAt, std::chrono::seconds{1}).has_value());
+        REQUIRE(*expiredAt - rescheduledAt >= std::chrono::milliseconds{50});
+        REQUIRE(expirations == 1);
+        REQUIRE(firstExpirations == 0);
+    }
+
+    SECTION("Timer longer than wheel turn stays in slot until its tick") {
+        // Eight slots of 10 ms, timer wraps wheel more than twice
+        auto scheduledAt = Clock::now();
+        timerWheel.schedule(timer, std::chrono::milliseconds{200}, onExpiration);
+        REQUIRE(runUntilExpired(ioContext, expiredAt, std::chrono::seconds{2}).has_value());
+        REQUIRE(*expiredAt - scheduledAt >= std::chrono::milliseconds{200});
+    }
+
+    SECTION("Timer scheduled while ticks lag behind clock keeps its timeout") {
+        // Io_context is busy, wheel does not tick for several ticks
+        std::this_thread::sleep_for(std::chrono::milliseconds{60});
+        auto scheduledAt = Clock::now();
+        timerWheel.schedule(timer, std::chrono::milliseconds{30}, onExpiration);
+        REQUIRE(runUntilExpired(ioContext, expiredAt, std::chrono::seconds{1}).has_value());
+        REQUIRE(*expiredAt - scheduledAt >= std::chrono::milliseconds{30});
+    }
+
+    SECTION("Lagging ticks expire overdue timers at once") {
+        timerWheel.schedule(timer, std::chrono::milliseconds{10}, onExpiration);
+        std::this_thread::sleep_for(std::chrono::milliseconds{60});
+        REQUIRE(runUntilExpired(ioContext, expiredAt, std::chrono::milliseconds{50}).has_value());
+    }
+
+    SECTION("Timer rescheduled from other thread while wheel ticks expires") {
+        // Connection strands reschedule timers on other threads than the one running wheel ticks
+        std::atomic<size_t> expirations{0};
+        std::thread ticking{[&]() { ioContext.run_for(std::chrono::milliseconds{300}); }};
+        for (size_t scheduleNr = 0; scheduleNr < 2000; scheduleNr++) {
+            timerWheel.schedule(timer, std::chrono::milliseconds{scheduleNr % 2 == 0 ? 0 : 10}, [&expirations]() { expirations++; });
+        }
+        ticking.join();
+        REQUIRE(expirations >= 1);
+        REQUIRE_FALSE(timer.isScheduled());
+    }
+
+    timerWheel.stop();
+    ioContext.poll();
+}
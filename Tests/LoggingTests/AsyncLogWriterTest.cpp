@@ -0,0 +1,114 @@
+#include "AsyncLogWriter.hpp"
+#include "spdlog/sinks/base_sink.h"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Sink remembering written messages, first write waits until gate is opened so queue behind it can be filled
+class GatedSink : public spdlog::sinks::base_sink<std::mutex> {
+private:
+    std::mutex gateLock;
+    std::condition_variable gateCondition;
+    bool gateOpened{false};
+    bool writing{false};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& message) override {
+        std::unique_lock guard(this->gateLock);
+        this->writing = true;
+        this->gateCondition.notify_all();
+        // Gate is never held for long, even when test fails before opening it
+        this->gateCondition.wait_for(guard, std::chrono::seconds{5}, [this]() { return this->gateOpened; });
+        this->messages.emplace_back(message.payload.data(), message.payload.size());
+    }
+
+    void flush_() override {
+        std::scoped_lock guard(this->gateLock);
+        this->flushedMessages = this->messages.size();
+    }
+
+public:
+    std::vector<std::string> messages;
+    size_t flushedMessages{0};
+
+    bool waitUntilWriting() {
+        std::unique_lock guard(this->gateLock);
+        return this->gateCondition.wait_for(guard, std::chrono::seconds{5}, [this]() { return this->writing; });
+    }
+
+    void open() {
+        std::scoped_lock guard(this->gateLock);
+        this->gateOpened = true;
+        this->gateCondition.notify_all();
+    }
+};
+
+// Leaves writer thread stuck in sink with first message while queue is filled with the next ones
+std::unique_ptr<AsyncLogWriter> makeFilledWriter(const std::shared_ptr<GatedSink>& sink, LogOverflowPolicy overflowPolicy) {
+    auto writer = std::make_unique<AsyncLogWriter>(sink, "Test", AsyncLogConfiguration{4, overflowPolicy});
+    writer->push(spdlog::level::info, "0");
+    REQUIRE(sink->waitUntilWriting());
+    for (const auto* text : {"1", "2", "3", "4"}) {
+        writer->push(spdlog::level::info, text);
+    }
+    REQUIRE(writer->getDroppedMessages() == 0);
+    return writer;
+}
+
+} // namespace
+
+TEST_CASE("AsyncLogWriter applies overflow policy when queue is full", "[LoggingTests][AsyncLogWriter]") {
+    auto sink = std::make_shared<GatedSink>();
+
+    SECTION("DropNew discards message which does not fit") {
+        auto writer = makeFilledWriter(sink, LogOverflowPolicy::DropNew);
+        writer->push(spdlog::level::info, "5");
+        REQUIRE(writer->getDroppedMessages() == 1);
+        sink->open();
+        writer.reset();
+        REQUIRE(sink->messages == std::vector<std::string>{"0", "1", "2", "3", "4", "AsyncLogWriter dropped 1 log messages"});
+    }
+
+    SECTION("DropOldest discards oldest queued message to make room") {
+        auto writer = makeFilledWriter(sink, LogOverflowPolicy::DropOldest);
+        writer->push(spdlog::level::info, "5");
+        REQUIRE(writer->getDroppedMessages() == 1);
+        sink->open();
+        writer.reset();
+        REQUIRE(sink->messages == std::vector<std::string>{"0", "2", "3", "4", "5", "AsyncLogWriter dropped 1 log messages"});
+    }
+
+    SECTION("Block waits until writer makes room") {
+        auto writer = makeFilledWriter(sink, LogOverflowPolicy::Block);
+        auto blockedPush = std::async(std::launch::async, [&writer]() { writer->push(spdlog::level::info, "5"); });
+        REQUIRE(blockedPush.wait_for(std::chrono::milliseconds{50}) == std::future_status::timeout);
+        sink->open();
+        REQUIRE(blockedPush.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+        writer.reset();
+        REQUIRE(sink->messages == std::vector<std::string>{"0", "1", "2", "3", "4", "5"});
+    }
+}
+
+TEST_CASE("AsyncLogWriter writes and flushes queued messages on shutdown", "[LoggingTests][AsyncLogWriter]") {
+    auto sink = std::make_shared<GatedSink>();
+    sink->open();
+    {
+        AsyncLogWriter writer{sink, "Test", AsyncLogConfiguration{64, LogOverflowPolicy::Block}};
+        for (size_t messageNr = 0; messageNr < 50; messageNr++) {
+            writer.push(spdlog::level::info, std::to_string(messageNr));
+        }
+        writer.push(spdlog::level::info, std::string(AsyncLogWriter::MaxMessageSize + 10, 'x'));
+    }
+    REQUIRE(sink->messages.size() == 51);
+    REQUIRE(sink->messages.front() == "0");
+    REQUIRE(sink->messages[49] == "49");
+    // Longer message is truncated
+    REQUIRE(sink->messages.back() == std::string(AsyncLogWriter::MaxMessageSize, 'x'));
+    REQUIRE(sink->flushedMessages == 51);
+}
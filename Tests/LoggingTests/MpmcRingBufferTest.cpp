@@ -0,0 +1,79 @@
+#include "MpmcRingBuffer.hpp"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MpmcRingBuffer keeps values in order within capacity", "[LoggingTests][MpmcRingBuffer]") {
+    SECTION("Capacity is rounded up to power of two") {
+        REQUIRE(MpmcRingBuffer<int>{0}.getCapacity() == 2);
+        REQUIRE(MpmcRingBuffer<int>{5}.getCapacity() == 8);
+        REQUIRE(MpmcRingBuffer<int>{16}.getCapacity() == 16);
+    }
+
+    SECTION("Push fails when full and pop fails when empty") {
+        MpmcRingBuffer<int> ring{4};
+        for (int value = 0; value < 4; value++) {
+            REQUIRE(ring.tryPush([value](int& slot) { slot = value; }));
+        }
+        REQUIRE_FALSE(ring.tryPush([](int& slot) { slot = 4; }));
+        for (int expected = 0; expected < 4; expected++) {
+            int popped{-1};
+            REQUIRE(ring.tryPop([&popped](int& slot) { popped = slot; }));
+            REQUIRE(popped == expected);
+        }
+        REQUIRE_FALSE(ring.tryPop([](int&) {}));
+    }
+
+    SECTION("Slots are reused over many turns of ring") {
+        MpmcRingBuffer<int> ring{4};
+        for (int value = 0; value < 100; value++) {
+            REQUIRE(ring.tryPush([value](int& slot) { slot = value; }));
+            REQUIRE(ring.tryPush([value](int& slot) { slot = -value; }));
+            int first{0};
+            int second{0};
+            REQUIRE(ring.tryPop([&first](int& slot) { first = slot; }));
+            REQUIRE(ring.tryPop([&second](int& slot) { second = slot; }));
+            REQUIRE(first == value);
+            REQUIRE(second == -value);
+        }
+    }
+}
+
+TEST_CASE("MpmcRingBuffer hands every value to exactly one consumer", "[LoggingTests][MpmcRingBuffer]") {
+    constexpr size_t ThreadsCount{4};
+    constexpr size_t ValuesPerProducer{20000};
+    MpmcRingBuffer<size_t> ring{64};
+    std::atomic<size_t> consumedCount{0};
+    std::atomic<size_t> consumedSum{0};
+
+    std::vector<std::thread> threads{};
+    for (size_t producerNr = 0; producerNr < ThreadsCount; producerNr++) {
+        threads.emplace_back([&ring, producerNr]() {
+            for (size_t valueNr = 0; valueNr < ValuesPerProducer; valueNr++) {
+                size_t value{producerNr * ValuesPerProducer + valueNr + 1};
+                while (!ring.tryPush([value](size_t& slot) { slot = value; })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (size_t consumerNr = 0; consumerNr < ThreadsCount; consumerNr++) {
+        threads.emplace_back([&]() {
+            while (consumedCount.load() < ThreadsCount * ValuesPerProducer) {
+                if (ring.tryPop([&consumedSum](size_t& slot) { consumedSum += slot; })) {
+                    consumedCount++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    size_t valuesCount{ThreadsCount * ValuesPerProducer};
+    REQUIRE(consumedCount == valuesCount);
+    REQUIRE(consumedSum == valuesCount * (valuesCount + 1) / 2);
+    REQUIRE_FALSE(ring.tryPop([](size_t&) {}));
+}
@@ -0,0 +1,128 @@
+#include "Metrics.hpp"
+#include <catch2/catch.hpp>
+#include <thread>
+#include <vector>
+
+using Metrics::Histogram;
+
+TEST_CASE("Histogram maps values to log-linear buckets", "[MetricsTests][Histogram]") {
+    SECTION("Values below SubBuckets have bucket of their own") {
+        for (uint64_t value = 0; value < Histogram::SubBuckets; value++) {
+            REQUIRE(Histogram::bucketIndex(value) == value);
+            REQUIRE(Histogram::bucketLowerBound(value) == value);
+            REQUIRE(Histogram::bucketUpperBound(value) == value);
+        }
+    }
+
+    SECTION("Every power of two is split into SubBuckets linear buckets") {
+        // 8 - 15 still have width 1, 16 - 31 width 2, 1024 - 2047 width 128
+        REQUIRE(Histogram::bucketIndex(8) == 8);
+        REQUIRE(Histogram::bucketIndex(15) == 15);
+        REQUIRE(Histogram::bucketIndex(16) == 16);
+        REQUIRE(Histogram::bucketIndex(17) == 16);
+        REQUIRE(Histogram::bucketIndex(18) == 17);
+        REQUIRE(Histogram::bucketIndex(31) == 23);
+        REQUIRE(Histogram::bucketIndex(32) == 24);
+        REQUIRE(Histogram::bucketIndex(1024) == 64);
+        REQUIRE(Histogram::bucketIndex(1151) == 64);
+        REQUIRE(Histogram::bucketIndex(1152) == 65);
+        REQUIRE(Histogram::bucketLowerBound(65) == 1152);
+        REQUIRE(Histogram::bucketUpperBound(64) == 1151);
+    }
+
+    SECTION("Whole uint64_t range fits into buckets") {
+        REQUIRE(Histogram::bucketIndex(UINT64_MAX) == Histogram::BucketsCount - 1);
+        REQUIRE(Histogram::bucketIndex(uint64_t{1} << 63) == Histogram::BucketsCount - Histogram::SubBuckets);
+        REQUIRE(Histogram::bucketUpperBound(Histogram::BucketsCount - 1) == UINT64_MAX);
+    }
+
+    SECTION("Bounds of every bucket map back to it and buckets leave no gaps") {
+        for (size_t index = 0; index < Histogram::BucketsCount; index++) {
+            REQUIRE(Histogram::bucketIndex(Histogram::bucketLowerBound(index)) == index);
+            REQUIRE(Histogram::bucketIndex(Histogram::bucketUpperBound(index)) == index);
+            if (index > 0) {
+                REQUIRE(Histogram::bucketLowerBound(index) == Histogram::bucketUpperBound(index - 1) + 1);
+            }
+        }
+    }
+
+    SECTION("Relative error of bucket stays below 1 / SubBuckets") {
+        for (size_t index = Histogram::SubBuckets; index < Histogram::BucketsCount; index++) {
+            uint64_t lowerBound = Histogram::bucketLowerBound(index);
+            uint64_t upperBound = Histogram::bucketUpperBound(index);
+            REQUIRE((upperBound - lowerBound) * Histogram::SubBuckets < lowerBound);
+        }
+    }
+}
+
+TEST_CASE("Histogram snapshot gives quantiles of recorded values", "[MetricsTests][Histogram]") {
+    Histogram histogram{};
+
+    SECTION("Empty histogram reports zero") {
+        auto snapshot = histogram.snapshot();
+        REQUIRE(snapshot.count == 0);
+        REQUIRE(snapshot.quantile(0.5) == 0);
+        REQUIRE(snapshot.quantile(0.99) == 0);
+    }
+
+    SECTION("Quantile is upper bound of bucket holding its rank") {
+        for (uint64_t value = 1; value <= 100; value++) {
+            histogram.record(value);
+        }
+        auto snapshot = histogram.snapshot();
+        REQUIRE(snapshot.count == 100);
+        REQUIRE(snapshot.sum == 5050);
+        // 50th value is 50, its bucket 48 - 51
+        REQUIRE(snapshot.quantile(0.5) == 51);
+        // 99th value is 99, its bucket 96 - 103
+        REQUIRE(snapshot.quantile(0.99) == 103);
+        REQUIRE(snapshot.quantile(1.0) == 103);
+        REQUIRE(snapshot.quantile(0.0) == 1);
+        // Quantile out of range is clamped
+        REQUIRE(snapshot.quantile(2.0) == 103);
+        REQUIRE(snapshot.quantile(-1.0) == 1);
+    }
+
+    SECTION("Rare slow values show only in high quantiles") {
+        for (size_t valueNr = 0; valueNr < 999; valueNr++) {
+            histogram.record(5);
+        }
+        histogram.record(1000000);
+        auto snapshot = histogram.snapshot();
+        REQUIRE(snapshot.quantile(0.5) == 5);
+        REQUIRE(snapshot.quantile(0.999) == 5);
+        REQUIRE(snapshot.quantile(1.0) >= 1000000);
+        REQUIRE(snapshot.quantile(1.0) < 1000000 + 1000000 / Histogram::SubBuckets);
+    }
+}
+
+TEST_CASE("Histogram snapshot merges shards of all recording threads", "[MetricsTests][Histogram]") {
+    constexpr size_t ThreadsCount{8};
+    constexpr uint64_t ValuesPerThread{10000};
+    Histogram histogram{};
+
+    std::vector<std::thread> threads{};
+    for (size_t threadNr = 0; threadNr < ThreadsCount; threadNr++) {
+        threads.emplace_back([&histogram, threadNr]() {
+            // Every thread records values of its own bucket
+            for (uint64_t valueNr = 0; valueNr < ValuesPerThread; valueNr++) {
+                histogram.record(threadNr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    histogram.record(ThreadsCount);
+
+    auto snapshot = histogram.snapshot();
+    REQUIRE(snapshot.count == ThreadsCount * ValuesPerThread + 1);
+    REQUIRE(snapshot.sum == ValuesPerThread * ThreadsCount * (ThreadsCount - 1) / 2 + ThreadsCount);
+    for (size_t threadNr = 0; threadNr < ThreadsCount; threadNr++) {
+        REQUIRE(snapshot.buckets[threadNr] == ValuesPerThread);
+    }
+    REQUIRE(snapshot.buckets[ThreadsCount] == 1);
+    // Rank of median falls just past values of first half of threads
+    REQUIRE(snapshot.quantile(0.5) == ThreadsCount / 2);
+    REQUIRE(snapshot.quantile(1.0) == ThreadsCount);
+}
@@ -7,16 +7,16 @@
 
 TEST_CASE("Tests module collection performance", "[MongoDatabase]") {
     // Prepare database
-    Mongo::DbEnvironment::initialize("127.0.0.1");
+    Mongo::DbEnvironment::initialize();
     auto modulesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
     Mongo::ModulesCollection modulesCollection{*modulesCollectionEntry, "ModulesTest"};
     modulesCollection.drop();
 
     // Insert one
     Types::ModuleIdentifier firstIdentifier{Types::toModuleIdentifier(1)};
-    Mongo::ModuleRecord firstRecord{};
+    ModuleRecord firstRecord{};
     firstRecord.identifier = firstIdentifier;
-    firstRecord.connectionState = Mongo::ConnectionState::Registered;
+    firstRecord.connectionState = ModuleRecord::ConnectionState::Registered;
     firstRecord.ipAddress = "127.0.0.1";
     auto start = std::chrono::high_resolution_clock::now();
     REQUIRE(modulesCollection.insertOne(std::move(firstRecord)) == true);
@@ -26,20 +26,18 @@ TEST_CASE("Tests module collection performance", "[MongoDatabase]") {
     // clean database before running multi insert
     modulesCollection.drop();
     
-    std::vector<Mongo::ModuleRecord> records{};
+    std::vector<ModuleRecord> records{};
     records.reserve(500);
     for(auto index = 0; index < 500; index++) {
-        Mongo::ModuleRecord record{};
-        firstRecord.identifier = Types::toModuleIdentifier(index);
-        firstRecord.connectionState = Mongo::ConnectionState::Registered;
-        firstRecord.ipAddress = "127.0.0.1";
+        ModuleRecord record{};
+        record.identifier = Types::toModuleIdentifier(index);
+        record.connectionState = ModuleRecord::ConnectionState::Registered;
+        record.ipAddress = "127.0.0.1";
         records.push_back(std::move(record));
     }
 
     auto startMulti = std::chrono::high_resolution_clock::now();
-    std::for_each(std::begin(records), std::end(records), [&](auto& record){
-        modulesCollection.insertOne(std::move(record));
-    });
+    REQUIRE(modulesCollection.insertMany(std::move(records)) == true);
     auto stopMulti = std::chrono::high_resolution_clock::now();
     auto elapsedTimeMulti = std::chrono::duration_cast<std::chrono::microseconds>(stopMulti - startMulti);
 
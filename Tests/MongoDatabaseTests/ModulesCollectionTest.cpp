@@ -12,9 +12,9 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     Types::ModuleIdentifier firstIdentifier{Types::toModuleIdentifier(1)};
     REQUIRE(modulesCollection.findOne(firstIdentifier) == false);
     
-    Mongo::ModuleRecord firstRecord{};
+    ModuleRecord firstRecord{};
     firstRecord.identifier = firstIdentifier;
-    firstRecord.connectionState = Mongo::ConnectionState::Registered;
+    firstRecord.connectionState = ModuleRecord::ConnectionState::Registered;
     firstRecord.ipAddress = "127.0.0.1";
     REQUIRE(modulesCollection.insertOne(std::move(firstRecord)) == true);
 
@@ -22,16 +22,16 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(firstGetRecord.has_value() == true);
     if(firstGetRecord.has_value() == true) {
         REQUIRE(firstGetRecord->identifier == firstIdentifier);
-        REQUIRE(firstGetRecord->connectionState == Mongo::ConnectionState::Registered);
+        REQUIRE(firstGetRecord->connectionState == ModuleRecord::ConnectionState::Registered);
         REQUIRE(firstGetRecord->ipAddress == "127.0.0.1");
     }
 
     REQUIRE(modulesCollection.findOne(firstIdentifier) == true);
 
     Types::ModuleIdentifier secondIdentifier{Types::toModuleIdentifier(2)};
-    Mongo::ModuleRecord secondRecord{};
+    ModuleRecord secondRecord{};
     secondRecord.identifier = secondIdentifier;
-    secondRecord.connectionState = Mongo::ConnectionState::Registered;
+    secondRecord.connectionState = ModuleRecord::ConnectionState::Registered;
     secondRecord.ipAddress = "127.0.0.1";
     REQUIRE(modulesCollection.insertOne(std::move(secondRecord)) == true);
     REQUIRE(modulesCollection.findOne(secondIdentifier) == true);
@@ -47,7 +47,7 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(firstGetRecord.has_value() == true);
     if(firstGetRecord.has_value() == true) {
         REQUIRE(firstGetRecord->identifier == firstIdentifier);
-        REQUIRE(firstGetRecord->connectionState == Mongo::ConnectionState::Disconnected);
+        REQUIRE(firstGetRecord->connectionState == ModuleRecord::ConnectionState::Disconnected);
         REQUIRE(firstGetRecord->ipAddress == "127.0.0.1");
     }
 
@@ -56,18 +56,18 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(firstGetRecord.has_value() == true);
     if(firstGetRecord.has_value() == true) {
         REQUIRE(firstGetRecord->identifier == firstIdentifier);
-        REQUIRE(firstGetRecord->connectionState == Mongo::ConnectionState::Registered);
+        REQUIRE(firstGetRecord->connectionState == ModuleRecord::ConnectionState::Registered);
         REQUIRE(firstGetRecord->ipAddress == "127.0.0.1");
     }
 
-    firstGetRecord->connectionState = Mongo::ConnectionState::Connected;
+    firstGetRecord->connectionState = ModuleRecord::ConnectionState::Connected;
     REQUIRE(modulesCollection.updateModule(std::move(*firstGetRecord)) == true);
 
     auto postUpdateGet = modulesCollection.getModule(firstIdentifier);
     REQUIRE(postUpdateGet.has_value() == true);
     if(postUpdateGet.has_value() == true) {
         REQUIRE(postUpdateGet->identifier == firstIdentifier);
-        REQUIRE(postUpdateGet->connectionState == Mongo::ConnectionState::Connected);
+        REQUIRE(postUpdateGet->connectionState == ModuleRecord::ConnectionState::Connected);
         REQUIRE(postUpdateGet->ipAddress == "127.0.0.1");
     }
 
@@ -81,4 +81,42 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(modulesCollection.setDisconnected(firstIdentifier) == true);
 
     modulesCollection.drop();
-}
\ No newline at end of file
+}
+
+TEST_CASE("Tests modules collection batch operations", "[MongoDatabase]") {
+    Mongo::DbEnvironment::initialize();
+    auto modulesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
+    Mongo::ModulesCollection modulesCollection{*modulesCollectionEntry, "ModulesTest"};
+    modulesCollection.drop();
+
+    std::vector<Types::ModuleIdentifier> identifiers{};
+    std::vector<ModuleRecord> records{};
+    for(auto index = 1; index <= 10; index++) {
+        ModuleRecord record{};
+        record.identifier = Types::toModuleIdentifier(index);
+        record.connectionState = ModuleRecord::ConnectionState::Registered;
+        record.ipAddress = "127.0.0.1";
+        identifiers.push_back(record.identifier);
+        records.push_back(std::move(record));
+    }
+    REQUIRE(modulesCollection.insertMany(std::move(records)) == true);
+    REQUIRE(modulesCollection.getAllModules().size() == 10);
+
+    auto selectedRecords = modulesCollection.getModules(std::span{identifiers}.first(5));
+    REQUIRE(selectedRecords.size() == 5);
+
+    for(auto& record : selectedRecords) {
+        record.connectionState = ModuleRecord::ConnectionState::Connected;
+    }
+    REQUIRE(modulesCollection.updateMany(selectedRecords) == true);
+    for(auto& record : modulesCollection.getModules(identifiers)) {
+        bool updated = record.identifier <= Types::toModuleIdentifier(5);
+        REQUIRE((record.connectionState == ModuleRecord::ConnectionState::Connected) == updated);
+    }
+
+    REQUIRE(modulesCollection.deleteMany(std::span{identifiers}.first(5)) == true);
+    REQUIRE(modulesCollection.getModules(identifiers).size() == 5);
+    REQUIRE(modulesCollection.getModules(std::span{identifiers}.first(5)).empty() == true);
+
+    modulesCollection.drop();
+}
@@ -0,0 +1,99 @@
+#include "MongoRecordsWriter.hpp"
+#include "Types.hpp"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Update = Mongo::RecordUpdate<ModuleRecord>;
+
+// Remembers every bulk handed to database instead of writing it, first failingBulks bulks are reported as failed
+struct RecordingDatabase {
+    std::mutex lock;
+    std::condition_variable condition;
+    std::vector<std::vector<Update>> bulks;
+    size_t failingBulks{0};
+
+    Mongo::ModulesWriter::BatchWriterFactory writerFactory() {
+        return [this]() -> Mongo::ModulesWriter::BatchWriter {
+            return [this](std::span<const Update> updates) {
+                std::scoped_lock guard(this->lock);
+                this->bulks.emplace_back(std::begin(updates), std::end(updates));
+                this->condition.notify_all();
+                return this->bulks.size() > this->failingBulks;
+            };
+        };
+    }
+
+    bool waitForBulks(size_t count) {
+        std::unique_lock guard(this->lock);
+        return this->condition.wait_for(guard, std::chrono::seconds{5}, [this, count]() { return this->bulks.size() >= count; });
+    }
+};
+
+ModuleRecord makeRecord(Types::Identifier identifierNr, ModuleRecord::ConnectionState state, std::string ipAddress) {
+    ModuleRecord record{};
+    record.identifier = Types::toModuleIdentifier(identifierNr);
+    record.connectionState = state;
+    record.ipAddress = std::move(ipAddress);
+    return record;
+}
+
+} // namespace
+
+TEST_CASE("Records writer coalesces and retries updates", "[MongoDatabase][RecordsWriter]") {
+    RecordingDatabase database{};
+
+    SECTION("Changes of the same record are written once with all changed fields") {
+        Mongo::ModulesWriter writer{"Modules", database.writerFactory(), 10, std::chrono::milliseconds{20}, std::chrono::milliseconds{20}};
+        writer.push(makeRecord(1, ModuleRecord::ConnectionState::Connected, ""), Types::RecordField::ConnectionState);
+        writer.push(makeRecord(2, ModuleRecord::ConnectionState::Connected, ""), Types::RecordField::ConnectionState);
+        writer.push(makeRecord(1, ModuleRecord::ConnectionState::Connected, "127.0.0.1"), Types::RecordField::IpAddress);
+        REQUIRE(database.waitForBulks(1));
+
+        std::scoped_lock guard(database.lock);
+        REQUIRE(database.bulks.size() == 1);
+        auto& bulk = database.bulks.front();
+        REQUIRE(bulk.size() == 2);
+        REQUIRE(bulk[0].record.identifier == Types::toModuleIdentifier(1));
+        REQUIRE(bulk[0].record.ipAddress == "127.0.0.1");
+        REQUIRE(bulk[0].fields == (Types::RecordField::ConnectionState | Types::RecordField::IpAddress));
+        REQUIRE(bulk[1].record.identifier == Types::toModuleIdentifier(2));
+    }
+
+    SECTION("Failed bulk is retried merged with newer changes of its records") {
+        database.failingBulks = 1;
+        Mongo::ModulesWriter writer{"Modules", database.writerFactory(), 10, std::chrono::milliseconds{20}, std::chrono::milliseconds{50}};
+        writer.push(makeRecord(1, ModuleRecord::ConnectionState::Connected, "127.0.0.1"),
+                    Types::RecordField::ConnectionState | Types::RecordField::IpAddress);
+        writer.push(makeRecord(2, ModuleRecord::ConnectionState::Connected, ""), Types::RecordField::ConnectionState);
+        REQUIRE(database.waitForBulks(1));
+        // Record changes again while failed bulk waits for retry
+        writer.push(makeRecord(1, ModuleRecord::ConnectionState::Disconnected, "127.0.0.1"), Types::RecordField::ConnectionState);
+        writer.push(makeRecord(3, ModuleRecord::ConnectionState::Connected, ""), Types::RecordField::ConnectionState);
+        REQUIRE(database.waitForBulks(2));
+
+        std::scoped_lock guard(database.lock);
+        auto& retriedBulk = database.bulks[1];
+        REQUIRE(retriedBulk.size() == 3);
+        // Failed updates keep their order ahead of newer records
+        REQUIRE(retriedBulk[0].record.identifier == Types::toModuleIdentifier(1));
+        REQUIRE(retriedBulk[0].record.connectionState == ModuleRecord::ConnectionState::Disconnected);
+        REQUIRE(retriedBulk[0].fields == (Types::RecordField::ConnectionState | Types::RecordField::IpAddress));
+        REQUIRE(retriedBulk[1].record.identifier == Types::toModuleIdentifier(2));
+        REQUIRE(retriedBulk[2].record.identifier == Types::toModuleIdentifier(3));
+    }
+
+    SECTION("Records pending at shutdown are flushed") {
+        {
+            Mongo::ModulesWriter writer{"Modules", database.writerFactory(), 10, std::chrono::seconds{10}, std::chrono::milliseconds{20}};
+            writer.push(makeRecord(1, ModuleRecord::ConnectionState::Registered, ""), Types::RecordField::ConnectionState);
+        }
+        std::scoped_lock guard(database.lock);
+        REQUIRE(database.bulks.size() == 1);
+        REQUIRE(database.bulks.front().size() == 1);
+    }
+}
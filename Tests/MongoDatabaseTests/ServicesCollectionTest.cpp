@@ -10,9 +10,9 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     servicesCollection.drop();
 
     Types::ServiceIdentifier firstIdentifier{Types::toServiceIdentifier(1)};
-    Mongo::ServiceRecord firstRecord{};
+    ServiceRecord firstRecord{};
     firstRecord.identifier = firstIdentifier;
-    firstRecord.connectionState = Mongo::ServiceConnectionState::Registered;
+    firstRecord.connectionState = ServiceRecord::ConnectionState::Registered;
     firstRecord.ipAddress = "127.0.0.1";
     REQUIRE(servicesCollection.insertOne(std::move(firstRecord)) == true);
 
@@ -20,13 +20,13 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(firstGetRecord.has_value() == true);
     if (firstGetRecord.has_value() == true) {
         REQUIRE(firstGetRecord->identifier == firstIdentifier);
-        REQUIRE(firstGetRecord->connectionState == Mongo::ServiceConnectionState::Registered);
+        REQUIRE(firstGetRecord->connectionState == ServiceRecord::ConnectionState::Registered);
         REQUIRE(firstGetRecord->ipAddress == "127.0.0.1");
     }
 
-    Mongo::ServiceRecord updatingRecord{};
+    ServiceRecord updatingRecord{};
     updatingRecord.identifier = firstIdentifier;
-    updatingRecord.connectionState = Mongo::ServiceConnectionState::Disconnected;
+    updatingRecord.connectionState = ServiceRecord::ConnectionState::Disconnected;
     updatingRecord.ipAddress = "127.1.5.1";
 
     REQUIRE(servicesCollection.updateService(std::move(updatingRecord)) == true);
@@ -35,9 +35,46 @@ TEST_CASE("Tests modules collection functionalities", "[MongoDatabase]") {
     REQUIRE(updatedRecord.has_value() == true);
     if (updatedRecord.has_value() == true) {
         REQUIRE(updatedRecord->identifier == firstIdentifier);
-        REQUIRE(updatedRecord->connectionState == Mongo::ServiceConnectionState::Disconnected);
+        REQUIRE(updatedRecord->connectionState == ServiceRecord::ConnectionState::Disconnected);
         REQUIRE(updatedRecord->ipAddress == "127.1.5.1");
     }
 
     servicesCollection.drop();
-}
\ No newline at end of file
+}
+TEST_CASE("Tests services collection batch operations", "[MongoDatabase]") {
+    Mongo::DbEnvironment::initialize();
+    auto servicesCollectionEntry = Mongo::DbEnvironment::getInstance()->getClient();
+    Mongo::ServicesCollection servicesCollection{*servicesCollectionEntry, "ServicesTest"};
+    servicesCollection.drop();
+
+    std::vector<Types::ServiceIdentifier> identifiers{};
+    std::vector<ServiceRecord> records{};
+    for (auto index = 1; index <= 10; index++) {
+        ServiceRecord record{};
+        record.identifier = Types::toServiceIdentifier(index);
+        record.connectionState = ServiceRecord::ConnectionState::Registered;
+        record.ipAddress = "127.0.0.1";
+        identifiers.push_back(record.identifier);
+        records.push_back(std::move(record));
+    }
+    REQUIRE(servicesCollection.insertMany(std::move(records)) == true);
+    REQUIRE(servicesCollection.getAllServices().size() == 10);
+
+    auto selectedRecords = servicesCollection.getServices(std::span{identifiers}.first(5));
+    REQUIRE(selectedRecords.size() == 5);
+
+    for (auto& record : selectedRecords) {
+        record.connectionState = ServiceRecord::ConnectionState::Connected;
+    }
+    REQUIRE(servicesCollection.updateMany(selectedRecords) == true);
+    for (auto& record : servicesCollection.getServices(identifiers)) {
+        bool updated = record.identifier <= Types::toServiceIdentifier(5);
+        REQUIRE((record.connectionState == ServiceRecord::ConnectionState::Connected) == updated);
+    }
+
+    REQUIRE(servicesCollection.deleteMany(std::span{identifiers}.first(5)) == true);
+    REQUIRE(servicesCollection.getServices(identifiers).size() == 5);
+    REQUIRE(servicesCollection.getServices(std::span{identifiers}.first(5)).empty() == true);
+
+    servicesCollection.drop();
+}
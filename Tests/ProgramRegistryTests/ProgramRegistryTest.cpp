@@ -0,0 +1,192 @@
+#include "ProgramRegistry.hpp"
+#include "Types.hpp"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ConnectionState = ModuleRecord::ConnectionState;
+
+// Database behind registry, counts lookups and remembers every written record
+struct FakeDatabase {
+    std::vector<ModuleRecord> stored;
+    size_t lookups{0};
+    std::vector<std::pair<ModuleRecord, Types::RecordField>> writes;
+    std::mutex writesLock;
+    // Lets other threads run between registry handing record over and record being written
+    bool slowWrites{false};
+
+    Watchdog::ModulesRegistry makeRegistry(std::chrono::milliseconds missTimeToLive = std::chrono::seconds{1}) {
+        return Watchdog::ModulesRegistry{[this](const Types::ModuleIdentifier& identifier) {
+                                             this->lookups++;
+                                             std::optional<ModuleRecord> found{std::nullopt};
+                                             for (auto& record : this->stored) {
+                                                 if (record.identifier == identifier) {
+                                                     found = record;
+                                                 }
+                                             }
+                                             return found;
+                                         },
+                                         [this](const ModuleRecord& record, Types::RecordField fields) {
+                                             if (this->slowWrites) {
+                                                 std::this_thread::yield();
+                                             }
+                                             std::scoped_lock guard(this->writesLock);
+                                             this->writes.emplace_back(record, fields);
+                                         },
+                                         missTimeToLive};
+    }
+};
+
+ModuleRecord makeRecord(Types::Identifier identifierNr, ConnectionState state) {
+    ModuleRecord record{};
+    record.identifier = Types::toModuleIdentifier(identifierNr);
+    record.connectionState = state;
+    record.ipAddress = "127.0.0.1";
+    return record;
+}
+
+} // namespace
+
+TEST_CASE("Program registry caches records", "[ProgramRegistry]") {
+    FakeDatabase database{};
+    auto firstIdentifier = Types::toModuleIdentifier(1);
+
+    SECTION("Loaded records are served without loader") {
+        auto registry = database.makeRegistry();
+        registry.load({makeRecord(1, ConnectionState::Registered), makeRecord(2, ConnectionState::Connected)});
+        REQUIRE(registry.size() == 2);
+        auto record = registry.get(firstIdentifier);
+        REQUIRE(record.has_value());
+        REQUIRE(record->connectionState == ConnectionState::Registered);
+        REQUIRE(database.lookups == 0);
+    }
+
+    SECTION("Record missing in cache is loaded once") {
+        database.stored.push_back(makeRecord(1, ConnectionState::Disconnected));
+        auto registry = database.makeRegistry();
+        REQUIRE(registry.get(firstIdentifier).has_value());
+        REQUIRE(registry.get(firstIdentifier).has_value());
+        REQUIRE(database.lookups == 1);
+        REQUIRE(registry.size() == 1);
+    }
+
+    SECTION("Unknown identifier is not looked up again until its miss expires") {
+        auto registry = database.makeRegistry(std::chrono::milliseconds{50});
+        REQUIRE_FALSE(registry.get(firstIdentifier).has_value());
+        REQUIRE_FALSE(registry.get(firstIdentifier).has_value());
+        REQUIRE(database.lookups == 1);
+
+        // Record registered meanwhile is found once miss expires
+        database.stored.push_back(makeRecord(1, ConnectionState::Registered));
+        std::this_thread::sleep_for(std::chrono::milliseconds{60});
+        REQUIRE(registry.get(firstIdentifier).has_value());
+        REQUIRE(database.lookups == 2);
+    }
+
+    SECTION("Loaded or updated record replaces remembered miss") {
+        auto registry = database.makeRegistry();
+        REQUIRE_FALSE(registry.get(firstIdentifier).has_value());
+        registry.load({makeRecord(1, ConnectionState::Registered)});
+        REQUIRE(registry.get(firstIdentifier).has_value());
+
+        auto secondIdentifier = Types::toModuleIdentifier(2);
+        REQUIRE_FALSE(registry.get(secondIdentifier).has_value());
+        REQUIRE(registry.update(makeRecord(2, ConnectionState::Registered)));
+        REQUIRE(registry.get(secondIdentifier).has_value());
+        REQUIRE(database.lookups == 2);
+    }
+
+    SECTION("Update writes whole record through") {
+        auto registry = database.makeRegistry();
+        REQUIRE(registry.update(makeRecord(1, ConnectionState::Registered)));
+        REQUIRE(database.writes.size() == 1);
+        REQUIRE(database.writes[0].first.identifier == firstIdentifier);
+        REQUIRE(database.writes[0].second == Types::RecordField::All);
+    }
+
+    SECTION("States are counted over all shards") {
+        auto registry = database.makeRegistry();
+        std::vector<ModuleRecord> records{};
+        for (Types::Identifier identifierNr = 1; identifierNr <= 40; identifierNr++) {
+            records.push_back(makeRecord(identifierNr, identifierNr % 4 == 0 ? ConnectionState::Connected : ConnectionState::Registered));
+        }
+        registry.load(std::move(records));
+        auto statesCount = registry.countByState();
+        REQUIRE(statesCount[ConnectionState::Connected] == 10);
+        REQUIRE(statesCount[ConnectionState::Registered] == 30);
+        REQUIRE(statesCount.count(ConnectionState::Disconnected) == 0);
+    }
+}
+
+TEST_CASE("Program registry transitions connection state", "[ProgramRegistry]") {
+    FakeDatabase database{};
+    auto registry = database.makeRegistry();
+    auto firstIdentifier = Types::toModuleIdentifier(1);
+    registry.load({makeRecord(1, ConnectionState::Registered)});
+
+    SECTION("Record in expected state is transitioned and written through") {
+        auto result = registry.transition(firstIdentifier, {ConnectionState::Registered, ConnectionState::Disconnected},
+                                          ConnectionState::Connected);
+        REQUIRE(result == Watchdog::TransitionResult::Transitioned);
+        REQUIRE(registry.get(firstIdentifier)->connectionState == ConnectionState::Connected);
+        REQUIRE(database.writes.size() == 1);
+        REQUIRE(database.writes[0].first.connectionState == ConnectionState::Connected);
+        REQUIRE(database.writes[0].second == Types::RecordField::ConnectionState);
+    }
+
+    SECTION("Record in other state is left untouched") {
+        auto result = registry.transition(firstIdentifier, {ConnectionState::Disconnected}, ConnectionState::Connected);
+        REQUIRE(result == Watchdog::TransitionResult::InvalidState);
+        REQUIRE(registry.get(firstIdentifier)->connectionState == ConnectionState::Registered);
+        REQUIRE(database.writes.empty());
+    }
+
+    SECTION("Unknown record is not found") {
+        auto result = registry.transition(Types::toModuleIdentifier(2), {ConnectionState::Registered}, ConnectionState::Connected);
+        REQUIRE(result == Watchdog::TransitionResult::NotFound);
+        REQUIRE(database.writes.empty());
+    }
+
+    SECTION("Only one of concurrent transitions from the same state succeeds") {
+        std::atomic<size_t> transitioned{0};
+        std::vector<std::thread> threads{};
+        for (size_t threadNr = 0; threadNr < 8; threadNr++) {
+            threads.emplace_back([&]() {
+                if (registry.transition(firstIdentifier, {ConnectionState::Registered}, ConnectionState::Connected) ==
+                    Watchdog::TransitionResult::Transitioned) {
+                    transitioned++;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(transitioned == 1);
+        REQUIRE(database.writes.size() == 1);
+    }
+
+    SECTION("Concurrent transitions are written in the order they were applied") {
+        // Connect and disconnect race on different threads, database must end in state kept in cache
+        database.slowWrites = true;
+        auto toggle = [&](ConnectionState from, ConnectionState to) {
+            for (size_t transitionNr = 0; transitionNr < 2000; transitionNr++) {
+                static_cast<void>(registry.transition(firstIdentifier, {from}, to));
+            }
+        };
+        std::thread connecting{toggle, ConnectionState::Registered, ConnectionState::Connected};
+        std::thread disconnecting{toggle, ConnectionState::Connected, ConnectionState::Registered};
+        connecting.join();
+        disconnecting.join();
+
+        REQUIRE_FALSE(database.writes.empty());
+        for (size_t writeNr = 1; writeNr < database.writes.size(); writeNr++) {
+            REQUIRE(database.writes[writeNr].first.connectionState != database.writes[writeNr - 1].first.connectionState);
+        }
+        REQUIRE(database.writes.back().first.connectionState == registry.get(firstIdentifier)->connectionState);
+    }
+}
@@ -32,6 +32,9 @@ public:
 TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[WatchdogTests]") {
     srand(time(NULL));
     auto& modulesCollection = *getModulesCollection().get();
+    Watchdog::ModulesRegistry modulesRegistry{
+        [&](const Types::ModuleIdentifier& identifier) { return modulesCollection.getModule(identifier); },
+        [&](const ModuleRecord& record, Types::RecordField fields) { modulesCollection.updateModule(ModuleRecord{record}, fields); }};
     Watchdog::ModuleAuthenticationData moduleAuthenticationData{};
     WatchdogModule::ConnectRequestData connectRequestData{};
     connectRequestData.set_identifier(Types::toModuleIdentifier(1));
@@ -41,7 +44,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{};
-        Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+        Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
         REQUIRE_THROWS_AS(connectHandler.createResponse(invalidMessage), Watchdog::ModuleRequestHandlerException);
     }
 
@@ -51,7 +54,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             connectRequestData.set_identifier(1);
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -64,7 +67,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         }
 
         SECTION("All parameters are valid") {
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -80,9 +83,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Registered state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Registered;
+        record.connectionState = ModuleRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -90,7 +93,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             connectRequestData.set_identifier(1);
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -104,7 +107,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         }
 
         SECTION("All parameters are valid") {
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -117,7 +120,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toModuleIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ModuleRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -127,9 +130,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Connected state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Connected;
+        record.connectionState = ModuleRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -138,7 +141,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             connectRequestData.set_identifier(1);
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -152,7 +155,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         }
 
         SECTION("All parameters are valid") {
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -164,7 +167,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toModuleIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ModuleRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -174,9 +177,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Disconnected state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Disconnected;
+        record.connectionState = ModuleRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -185,7 +188,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             connectRequestData.set_identifier(1);
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -199,7 +202,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         }
 
         SECTION("All parameters are valid") {
-            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleConnectRequestHandler connectHandler{moduleAuthenticationData, modulesRegistry, setTimer};
             auto response = connectHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogModule::Operation::ConnectResponse);
             WatchdogModule::ConnectResponseData responseData{};
@@ -211,7 +214,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toModuleIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ModuleRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
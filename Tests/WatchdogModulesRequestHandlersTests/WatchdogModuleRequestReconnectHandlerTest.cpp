@@ -27,6 +27,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
     srand(time(NULL));
 
     auto& modulesCollection = *getModulesCollection().get();
+    Watchdog::ModulesRegistry modulesRegistry{
+        [&](const Types::ModuleIdentifier& identifier) { return modulesCollection.getModule(identifier); },
+        [&](const ModuleRecord& record, Types::RecordField fields) { modulesCollection.updateModule(ModuleRecord{record}, fields); }};
     modulesCollection.drop();
     auto setTimer = std::bind([]() { std::cout << "SET TIMER FUNC" << std::endl; });
     WatchdogModule::ReconnectRequestData reconnectRequest{};
@@ -36,7 +39,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{};
-        Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+        Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
         REQUIRE_THROWS_AS(reconnectHandler.createResponse(invalidMessage), Watchdog::ModuleRequestHandlerException);
     }
 
@@ -46,7 +49,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(1);
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -58,7 +61,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(Types::toModuleIdentifier(1));
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -69,9 +72,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
     }
 
     SECTION("Module exists in database - Registered state") {
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Registered;
+        record.connectionState = ModuleRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -79,7 +82,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(1);
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -92,7 +95,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(Types::toModuleIdentifier(1));
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -103,9 +106,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
     }
 
     SECTION("Module exists in database - Connected state") {
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Connected;
+        record.connectionState = ModuleRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -113,7 +116,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(1);
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -126,7 +129,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(Types::toModuleIdentifier(1));
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -137,9 +140,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
     }
 
     SECTION("Module exists in database - Disconnected state") {
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Disconnected;
+        record.connectionState = ModuleRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -147,7 +150,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(1);
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
@@ -160,13 +163,19 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             reconnectRequest.set_identifier(Types::toModuleIdentifier(1));
             reconnectRequest.SerializeToString(&message);
 
-            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesCollection, setTimer};
+            Watchdog::ModuleReconnectRequestHandler reconnectHandler{authenticationData, modulesRegistry, setTimer};
             auto response = reconnectHandler.createResponse(message);
             WatchdogModule::ReconnectResponseData responseData{};
             responseData.ParseFromString(response.body);
             REQUIRE(responseData.responsecode() == WatchdogModule::ReconnectResponseData::Success);
             REQUIRE(responseData.has_sequencecode() == true);
             REQUIRE(responseData.sequencecode() != 1410);
+            // Reconnected record is the one disconnect of this connection changes later
+            REQUIRE(authenticationData.identifier == Types::toModuleIdentifier(1));
+
+            auto checkRecord = modulesCollection.getModule(Types::toModuleIdentifier(1));
+            REQUIRE(checkRecord.has_value() == true);
+            REQUIRE(checkRecord->connectionState == ModuleRecord::ConnectionState::Connected);
             modulesCollection.drop();
         }
     }
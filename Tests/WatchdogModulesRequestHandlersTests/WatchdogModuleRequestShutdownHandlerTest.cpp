@@ -5,6 +5,8 @@
 #include "WatchdogModuleRequestsHandlers.hpp"
 #include <catch2/catch.hpp>
 
+using ErrorCode = Watchdog::ModuleRequestHandlerException::ErrorCode;
+
 class MongoDbConnection {
 private:
     std::unique_ptr<Mongo::ModulesCollection> modulesCollection{nullptr};
@@ -23,8 +25,30 @@ public:
     std::unique_ptr<Mongo::ModulesCollection>& getModulesCollection() { return this->modulesCollection; }
 };
 
+namespace {
+
+// Shutdown never responds, outcome is told by error code of thrown exception
+ErrorCode shutdownErrorCode(Watchdog::ModuleShutdownRequestHandler& shutdownHandler, const std::string& message) {
+    ErrorCode errorCode{ErrorCode::Unknown};
+    try {
+        static_cast<void>(shutdownHandler.createResponse(message));
+    } catch (Watchdog::ModuleRequestHandlerException& exception) {
+        errorCode = exception.getErrorCode();
+    }
+    return errorCode;
+}
+
+} // namespace
+
 TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "[WatchdogTests]") {
     auto& modulesCollection = *getModulesCollection().get();
+    size_t writesCount{0};
+    Watchdog::ModulesRegistry modulesRegistry{
+        [&](const Types::ModuleIdentifier& identifier) { return modulesCollection.getModule(identifier); },
+        [&](const ModuleRecord& record, Types::RecordField fields) {
+            writesCount++;
+            modulesCollection.updateModule(ModuleRecord{record}, fields);
+        }};
 
     WatchdogModule::ShutdownRequestData shutdownRequest{};
     Watchdog::ModuleAuthenticationData authenticationData{};
@@ -32,8 +56,8 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{};
-        Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-        REQUIRE_THROWS_AS(shutdownHandler.createResponse(invalidMessage), Watchdog::ModuleRequestHandlerException);
+        Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+        REQUIRE(shutdownErrorCode(shutdownHandler, invalidMessage) == ErrorCode::FailedToParse);
     }
 
     SECTION("Module doesnt exists in database") {
@@ -41,24 +65,25 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "
             shutdownRequest.set_identifier(1);
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::Dropped);
         }
 
-        SECTION("Invalid module identifier") {
+        SECTION("Unknown module identifier") {
             shutdownRequest.set_identifier(Types::toModuleIdentifier(1));
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::Dropped);
+            REQUIRE(writesCount == 0);
         }
     }
 
     SECTION("Module exists in database - Registered state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Registered;
+        record.connectionState = ModuleRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -66,29 +91,31 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "
             shutdownRequest.set_identifier(1);
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::Dropped);
         }
 
-        SECTION("All parameters are valid") {
+        SECTION("Registered module is not shut down") {
             shutdownRequest.set_identifier(Types::toModuleIdentifier(1));
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            // Only connected or disconnected module goes back to registered, request is ignored
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 0);
 
             auto updatedRecord = modulesCollection.getModule(Types::toModuleIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ModuleRecord::ConnectionState::Registered);
         }
         modulesCollection.drop();
     }
 
     SECTION("Module exists in database - Connected state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Connected;
+        record.connectionState = ModuleRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -96,29 +123,30 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "
             shutdownRequest.set_identifier(1);
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::Dropped);
         }
 
         SECTION("All parameters are valid") {
             shutdownRequest.set_identifier(Types::toModuleIdentifier(1));
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 1);
 
             auto updatedRecord = modulesCollection.getModule(Types::toModuleIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ModuleRecord::ConnectionState::Registered);
         }
         modulesCollection.drop();
     }
 
     SECTION("Module exists in database - Disconnected state") {
         modulesCollection.drop();
-        Mongo::ModuleRecord record{};
+        ModuleRecord record{};
         record.identifier = Types::toModuleIdentifier(1);
-        record.connectionState = Mongo::ConnectionState::Disconnected;
+        record.connectionState = ModuleRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         modulesCollection.insertOne(std::move(record));
 
@@ -126,21 +154,22 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "
             shutdownRequest.set_identifier(1);
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::Dropped);
         }
 
         SECTION("All parameters are valid") {
             shutdownRequest.set_identifier(Types::toModuleIdentifier(1));
             shutdownRequest.SerializeToString(&message);
 
-            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesCollection};
-            REQUIRE_THROWS(shutdownHandler.createResponse(message));
+            Watchdog::ModuleShutdownRequestHandler shutdownHandler{authenticationData, modulesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownHandler, message) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 1);
 
             auto updatedRecord = modulesCollection.getModule(Types::toModuleIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ModuleRecord::ConnectionState::Registered);
         }
         modulesCollection.drop();
     }
-}
\ No newline at end of file
+}
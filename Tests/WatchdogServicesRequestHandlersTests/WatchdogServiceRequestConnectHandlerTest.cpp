@@ -30,12 +30,15 @@ public:
 TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[WatchdogTests]") {
     srand(time(NULL));
     auto& servicesCollection = *getServicesCollection().get();
+    Watchdog::ServicesRegistry servicesRegistry{
+        [&](const Types::ServiceIdentifier& identifier) { return servicesCollection.getService(identifier); },
+        [&](const ServiceRecord& record, Types::RecordField fields) { servicesCollection.updateService(ServiceRecord{record}, fields); }};
     auto setTimer = std::bind([]() { std::cout << "SET TIMER FUNC" << std::endl; });
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{"abcd"}; // Just random string
         Watchdog::ServiceAuthenticationData serviceAuthenticationData{};
-        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         REQUIRE_THROWS_AS(serviceConnectRequestHandler.createResponse(invalidMessage), Watchdog::ServiceRequestHandlerException);
     }
 
@@ -48,7 +51,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
         connectRequestData.SerializeToString(&message->body);
 
-        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         auto response = serviceConnectRequestHandler.createResponse(message->body);
         REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
         WatchdogService::ConnectResponseData responseData{};
@@ -69,7 +72,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
         auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
         connectRequestData.SerializeToString(&message->body);
 
-        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         auto response = serviceConnectRequestHandler.createResponse(message->body);
         REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
         WatchdogService::ConnectResponseData responseData{};
@@ -83,9 +86,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Registered state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Registered;
+        record.connectionState = ServiceRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -97,7 +100,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -114,7 +117,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -126,7 +129,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -134,9 +137,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Connected state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Connected;
+        record.connectionState = ServiceRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -148,7 +151,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -165,7 +168,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -177,7 +180,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -185,9 +188,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
 
     SECTION("Module exists in database - Disconnected state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Disconnected;
+        record.connectionState = ServiceRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -199,7 +202,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -216,7 +219,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             connectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+            Watchdog::ServiceConnectRequestHandler serviceConnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
             auto response = serviceConnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ConnectResponse);
             WatchdogService::ConnectResponseData responseData{};
@@ -229,7 +232,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
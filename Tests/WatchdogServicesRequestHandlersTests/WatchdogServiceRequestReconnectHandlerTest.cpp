@@ -30,12 +30,15 @@ public:
 TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality", "[WatchdogTests]") {
     srand(time(NULL));
     auto& servicesCollection = *getServicesCollection().get();
+    Watchdog::ServicesRegistry servicesRegistry{
+        [&](const Types::ServiceIdentifier& identifier) { return servicesCollection.getService(identifier); },
+        [&](const ServiceRecord& record, Types::RecordField fields) { servicesCollection.updateService(ServiceRecord{record}, fields); }};
     auto setTimer = std::bind([]() { std::cout << "SET TIMER FUNC" << std::endl; });
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{"abcd"}; // Just random string
         Watchdog::ServiceAuthenticationData serviceAuthenticationData{};
-        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         REQUIRE_THROWS_AS(serviceReconnectRequestHandler.createResponse(invalidMessage), Watchdog::ServiceRequestHandlerException);
     }
 
@@ -48,7 +51,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
         auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
         reconnectRequestData.SerializeToString(&message->body);
 
-        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         auto response = serviceReconnectRequestHandler.createResponse(message->body);
         REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
         WatchdogService::ReconnectResponseData reconnectResponseData{};
@@ -69,7 +72,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
         auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
         reconnectRequestData.SerializeToString(&message->body);
 
-        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection, setTimer};
+        Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry, setTimer};
         auto response = serviceReconnectRequestHandler.createResponse(message->body);
         REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
         WatchdogService::ReconnectResponseData reconnectResponseData{};
@@ -83,9 +86,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
 
     SECTION("Module exists in database - Registered state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Registered;
+        record.connectionState = ServiceRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -97,7 +100,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -115,7 +118,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -128,7 +131,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Registered);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Registered);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -136,9 +139,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
 
     SECTION("Module exists in database - Connected state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Connected;
+        record.connectionState = ServiceRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -150,7 +153,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -168,7 +171,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -181,7 +184,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -189,9 +192,9 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
 
     SECTION("Module exists in database - Disconnected state") {
         servicesCollection.drop();
-        Mongo::ServiceRecord record{};
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Disconnected;
+        record.connectionState = ServiceRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
@@ -203,7 +206,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -221,7 +224,7 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
             auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
             reconnectRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesCollection,
+            Watchdog::ServiceReconnectRequestHandler serviceReconnectRequestHandler{serviceAuthenticationData, servicesRegistry,
                                                                                     setTimer};
             auto response = serviceReconnectRequestHandler.createResponse(message->body);
             REQUIRE(response.header.operationCode == WatchdogService::Operation::ReconnectResponse);
@@ -230,12 +233,14 @@ TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog reconnect functionality",
 
             REQUIRE(reconnectResponseData.responsecode() == WatchdogService::Success);
             REQUIRE(reconnectResponseData.has_sequencecode() == true);
+            // Reconnected record is the one disconnect of this connection changes later
+            REQUIRE(serviceAuthenticationData.identifier == Types::toServiceIdentifier(1));
 
             auto checkRecord = servicesCollection.getService(Types::toServiceIdentifier(1));
             REQUIRE(checkRecord.has_value() == true);
             if (checkRecord.has_value()) {
                 REQUIRE(checkRecord->identifier == Types::toServiceIdentifier(1));
-                REQUIRE(checkRecord->connectionState == Mongo::ServiceConnectionState::Connected);
+                REQUIRE(checkRecord->connectionState == ServiceRecord::ConnectionState::Connected);
                 REQUIRE(checkRecord->ipAddress == "127.0.0.1");
             }
         }
@@ -4,6 +4,8 @@
 #include "WatchdogServiceRequestsHandlers.hpp"
 #include <catch2/catch.hpp>
 
+using ErrorCode = Watchdog::ServiceRequestHandlerException::ErrorCode;
+
 class MongoDbConnection {
 private:
     std::unique_ptr<Mongo::ServicesCollection> servicesCollection{nullptr};
@@ -27,119 +29,144 @@ public:
     std::unique_ptr<Mongo::ServicesCollection>& getServicesCollection() { return this->servicesCollection; }
 };
 
-TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog connect functionality", "[WatchdogTests]") {
-    srand(time(NULL));
+namespace {
+
+// Shutdown never responds, outcome is told by error code of thrown exception
+ErrorCode shutdownErrorCode(Watchdog::ServiceShutdownRequestHandler& shutdownHandler, const std::string& message) {
+    ErrorCode errorCode{ErrorCode::Unknown};
+    try {
+        static_cast<void>(shutdownHandler.createResponse(message));
+    } catch (Watchdog::ServiceRequestHandlerException& exception) {
+        errorCode = exception.getErrorCode();
+    }
+    return errorCode;
+}
+
+} // namespace
+
+TEST_CASE_METHOD(MongoDbConnection, "Testing watchdog shutdown functionality", "[WatchdogTests]") {
     auto& servicesCollection = *getServicesCollection().get();
+    size_t writesCount{0};
+    Watchdog::ServicesRegistry servicesRegistry{
+        [&](const Types::ServiceIdentifier& identifier) { return servicesCollection.getService(identifier); },
+        [&](const ServiceRecord& record, Types::RecordField fields) {
+            writesCount++;
+            servicesCollection.updateService(ServiceRecord{record}, fields);
+        }};
     Watchdog::ServiceAuthenticationData serviceAuthenticationData{};
-    auto setTimer = std::bind([]() { std::cout << "SET TIMER FUNC" << std::endl; });
 
     SECTION("Parsing invalid message") {
         std::string invalidMessage{};
-        Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-        REQUIRE_THROWS_AS(shutdownRequestHandler.createResponse(invalidMessage), Watchdog::ServiceRequestHandlerException);
+        Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+        REQUIRE(shutdownErrorCode(shutdownRequestHandler, invalidMessage) == ErrorCode::FailedToParse);
     }
 
     WatchdogService::ShutdownRequestData shutdownRequestData{};
     auto message = std::make_unique<Communication::Message<WatchdogService::Operation>>();
-    SECTION("Module doesnt exists in database") {
-        SECTION("Invalid module identifier") {
+    SECTION("Service doesnt exists in database") {
+        SECTION("Invalid service identifier") {
             shutdownRequestData.set_identifier(1);
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::Dropped);
         }
 
-        SECTION("Invalid module identifier") {
+        SECTION("Unknown service identifier") {
             shutdownRequestData.set_identifier(Types::toServiceIdentifier(1));
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::Dropped);
+            REQUIRE(writesCount == 0);
         }
     }
 
-    SECTION("Module exists in database - Registered state") {
-        Mongo::ServiceRecord record{};
+    SECTION("Service exists in database - Registered state") {
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Registered;
+        record.connectionState = ServiceRecord::ConnectionState::Registered;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
-        SECTION("Invalid module identifier") {
+        SECTION("Invalid service identifier") {
             shutdownRequestData.set_identifier(1);
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::Dropped);
         }
 
-        SECTION("All parameters are valid") {
+        SECTION("Registered service is not shut down") {
             shutdownRequestData.set_identifier(Types::toServiceIdentifier(1));
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            // Only connected or disconnected service goes back to registered, request is ignored
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 0);
 
             auto updatedRecord = servicesCollection.getService(Types::toServiceIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ServiceConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ServiceRecord::ConnectionState::Registered);
         }
     }
 
-    SECTION("Module exists in database - Connected state") {
-        Mongo::ServiceRecord record{};
+    SECTION("Service exists in database - Connected state") {
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Connected;
+        record.connectionState = ServiceRecord::ConnectionState::Connected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
-        SECTION("Invalid module identifier") {
+        SECTION("Invalid service identifier") {
             shutdownRequestData.set_identifier(1);
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::Dropped);
         }
 
         SECTION("All parameters are valid") {
             shutdownRequestData.set_identifier(Types::toServiceIdentifier(1));
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 1);
 
             auto updatedRecord = servicesCollection.getService(Types::toServiceIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ServiceConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ServiceRecord::ConnectionState::Registered);
         }
     }
 
-    SECTION("Module exists in database - Disconnected state") {
-        Mongo::ServiceRecord record{};
+    SECTION("Service exists in database - Disconnected state") {
+        ServiceRecord record{};
         record.identifier = Types::toServiceIdentifier(1);
-        record.connectionState = Mongo::ServiceConnectionState::Disconnected;
+        record.connectionState = ServiceRecord::ConnectionState::Disconnected;
         record.ipAddress = "127.0.0.1";
         servicesCollection.insertOne(std::move(record));
 
-        SECTION("Invalid module identifier") {
+        SECTION("Invalid service identifier") {
             shutdownRequestData.set_identifier(1);
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::Dropped);
         }
 
         SECTION("All parameters are valid") {
             shutdownRequestData.set_identifier(Types::toServiceIdentifier(1));
             shutdownRequestData.SerializeToString(&message->body);
 
-            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesCollection};
-            REQUIRE_THROWS(shutdownRequestHandler.createResponse(message->body));
+            Watchdog::ServiceShutdownRequestHandler shutdownRequestHandler{serviceAuthenticationData, servicesRegistry};
+            REQUIRE(shutdownErrorCode(shutdownRequestHandler, message->body) == ErrorCode::NoResponseRequired);
+            REQUIRE(writesCount == 1);
 
             auto updatedRecord = servicesCollection.getService(Types::toServiceIdentifier(1));
             REQUIRE(updatedRecord.has_value() == true);
-            REQUIRE(updatedRecord->connectionState == Mongo::ServiceConnectionState::Registered);
+            REQUIRE(updatedRecord->connectionState == ServiceRecord::ConnectionState::Registered);
         }
     }
     servicesCollection.drop();
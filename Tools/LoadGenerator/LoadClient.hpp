@@ -0,0 +1,306 @@
+#pragma once
+#include "Communication.hpp"
+#include "Connection.hpp"
+#include "IoContextPool.hpp"
+#include "Metrics.hpp"
+#include "Types.hpp"
+#include "WatchdogModule.pb.h"
+#include "WatchdogService.pb.h"
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace LoadGenerator {
+
+struct LoadConfiguration {
+    std::string host{"127.0.0.1"};
+    size_t modules{100};
+    size_t services{0};
+    // Clients use consecutive identifiers starting from this number
+    Types::Identifier firstIdentifier{1};
+    std::chrono::milliseconds pingInterval{1000};
+    // Pings sent after connect and again after reconnect
+    size_t pingsPerSession{10};
+    // Connect -> Ping -> Reconnect -> Ping -> Shutdown lifecycles done by every client
+    size_t cycles{1};
+    // Clients started per second, 0 starts all of them at once
+    size_t connectRate{500};
+    std::chrono::milliseconds responseTimeout{8000};
+    size_t threads{std::max(1u, std::thread::hardware_concurrency())};
+    std::chrono::seconds reportInterval{5};
+    // Insert clients records into mongodb before they connect
+    bool seed{false};
+};
+
+// Shared by all clients, histograms and counters are recorded per thread so clients do not contend
+struct LoadStatistics {
+    Metrics::Histogram connectLatency;
+    Metrics::Histogram pingLatency;
+    Metrics::Histogram reconnectLatency;
+    Metrics::Counter responses;
+    Metrics::Counter timeouts;
+    Metrics::Counter disconnects;
+    Metrics::Counter rejected;
+    Metrics::Counter activeClients;
+    std::atomic<size_t> finishedClients{0};
+};
+
+struct ModuleProtocol {
+    using Operation = WatchdogModule::Operation;
+    using ConnectRequest = WatchdogModule::ConnectRequestData;
+    using ConnectResponse = WatchdogModule::ConnectResponseData;
+    using PingRequest = WatchdogModule::PingRequestData;
+    using PingResponse = WatchdogModule::PingResponseData;
+    using ReconnectRequest = WatchdogModule::ReconnectRequestData;
+    using ReconnectResponse = WatchdogModule::ReconnectResponseData;
+    using ShutdownRequest = WatchdogModule::ShutdownRequestData;
+    static constexpr auto ConnectSuccess = WatchdogModule::ConnectResponseData::Success;
+    static constexpr auto ReconnectSuccess = WatchdogModule::ReconnectResponseData::Success;
+    static constexpr auto ReconnectInvalidState = WatchdogModule::ReconnectResponseData::InvalidConnectionState;
+    static constexpr uint16_t Port{1234};
+
+    static Types::Identifier makeIdentifier(Types::Identifier number) { return Types::toModuleIdentifier(number); }
+};
+
+struct ServiceProtocol {
+    using Operation = WatchdogService::Operation;
+    using ConnectRequest = WatchdogService::ConnectRequestData;
+    using ConnectResponse = WatchdogService::ConnectResponseData;
+    using PingRequest = WatchdogService::PingRequestData;
+    using PingResponse = WatchdogService::PingResponseData;
+    using ReconnectRequest = WatchdogService::ReconnectRequestData;
+    using ReconnectResponse = WatchdogService::ReconnectResponseData;
+    using ShutdownRequest = WatchdogService::ShutdownRequestData;
+    static constexpr auto ConnectSuccess = WatchdogService::Success;
+    static constexpr auto ReconnectSuccess = WatchdogService::Success;
+    static constexpr auto ReconnectInvalidState = WatchdogService::InvalidConnectionState;
+    static constexpr uint16_t Port{1235};
+
+    static Types::Identifier makeIdentifier(Types::Identifier number) { return Types::toServiceIdentifier(number); }
+};
+
+enum class RequestResult { Response, Timeout, Disconnected };
+
+// Client side of single watchdog connection, framing is shared with watchdog through TcpConnection.
+// Only one request is in flight at a time, its response wakes up requesting coroutine.
+template <typename Protocol> class ClientConnection : public Connection::TcpConnection<typename Protocol::Operation> {
+public:
+    using Operation = typename Protocol::Operation;
+
+private:
+    boost::asio::steady_timer responseTimer;
+    std::optional<Communication::Message<Operation>> response{std::nullopt};
+
+protected:
+    boost::asio::awaitable<void> handleReceivedMessage(Communication::MessageView<Operation> receivedMessage) override {
+        this->response = Communication::Message<Operation>{receivedMessage.header, std::string{receivedMessage.body}};
+        this->responseTimer.cancel();
+        co_return;
+    }
+    // Watchdog never pings clients
+    void onTimerExpiration() override {}
+    bool acceptPing(uint32_t) override { return false; }
+
+public:
+    ClientConnection(boost::asio::io_context& ioContext, Connection::TimerWheel& timerWheel)
+        : Connection::TcpConnection<Operation>{ioContext, timerWheel}, responseTimer{ioContext} {}
+
+    void disconnect() override {
+        Connection::TcpConnection<Operation>::disconnect();
+        this->responseTimer.cancel();
+    }
+
+    [[nodiscard]] bool isSending() const { return this->sendingInProgress; }
+
+    // Response body is parsed into response when given, otherwise request is only sent
+    boost::asio::awaitable<RequestResult> request(Operation operation, const google::protobuf::MessageLite& requestBody,
+                                                  google::protobuf::MessageLite* responseBody, std::chrono::milliseconds timeout) {
+        Communication::Message<Operation> message{};
+        message.header.operationCode = operation;
+        message.header.size = static_cast<uint32_t>(requestBody.ByteSizeLong());
+        message.body = requestBody.SerializeAsString();
+        this->response.reset();
+        this->sendMessage(std::move(message));
+        RequestResult result{RequestResult::Response};
+        if (responseBody != nullptr) {
+            boost::system::error_code error{};
+            this->responseTimer.expires_after(timeout);
+            co_await this->responseTimer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            if (this->response.has_value()) {
+                responseBody->ParseFromString(this->response->body);
+            } else if (!this->isConnected()) {
+                result = RequestResult::Disconnected;
+            } else {
+                result = RequestResult::Timeout;
+            }
+        }
+        co_return result;
+    }
+};
+
+// Simulated program, drives its lifecycle on single shard so it needs no synchronization with its connections
+template <typename Protocol> class LoadClient {
+private:
+    using Operation = typename Protocol::Operation;
+    using ConnectionPointer = std::shared_ptr<ClientConnection<Protocol>>;
+
+    Watchdog::IoContextPool::Shard& shard;
+    const LoadConfiguration& configuration;
+    LoadStatistics& statistics;
+    Types::Identifier identifier;
+    uint32_t sequenceCode{0};
+    boost::asio::steady_timer delayTimer;
+
+    boost::asio::awaitable<void> delay(std::chrono::milliseconds duration) {
+        boost::system::error_code error{};
+        this->delayTimer.expires_after(duration);
+        co_await this->delayTimer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    }
+
+    static void recordLatency(Metrics::Histogram& histogram, std::chrono::steady_clock::time_point start) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        histogram.record(static_cast<uint64_t>(elapsed.count()));
+    }
+
+    void countFailure(RequestResult result) {
+        if (result == RequestResult::Timeout) {
+            this->statistics.timeouts.add();
+        } else if (result == RequestResult::Disconnected) {
+            this->statistics.disconnects.add();
+        }
+    }
+
+    boost::asio::awaitable<ConnectionPointer> open() {
+        auto connection = std::make_shared<ClientConnection<Protocol>>(this->shard.ioContext, this->shard.timerWheel);
+        boost::system::error_code error{};
+        boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::make_address(this->configuration.host), Protocol::Port};
+        co_await connection->getSocket().async_connect(endpoint, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        if (error) {
+            this->statistics.disconnects.add();
+            connection = nullptr;
+        } else {
+            connection->startReading();
+        }
+        co_return connection;
+    }
+
+    boost::asio::awaitable<bool> connect(ConnectionPointer& connection) {
+        typename Protocol::ConnectRequest request{};
+        typename Protocol::ConnectResponse response{};
+        request.set_identifier(this->identifier);
+        auto start = std::chrono::steady_clock::now();
+        auto result = co_await connection->request(Operation::ConnectRequest, request, &response, this->configuration.responseTimeout);
+        bool connected{false};
+        if (result != RequestResult::Response) {
+            this->countFailure(result);
+        } else if (response.responsecode() != Protocol::ConnectSuccess) {
+            this->statistics.rejected.add();
+        } else {
+            recordLatency(this->statistics.connectLatency, start);
+            this->statistics.responses.add();
+            this->sequenceCode = response.sequencecode();
+            connected = true;
+        }
+        co_return connected;
+    }
+
+    // Watchdog marks program disconnected only after it notices closed socket, so rejected reconnect is retried
+    boost::asio::awaitable<bool> reconnect(ConnectionPointer& connection) {
+        static constexpr size_t ReconnectAttempts{5};
+        typename Protocol::ReconnectRequest request{};
+        request.set_identifier(this->identifier);
+        bool reconnected{false};
+        for (size_t attempt = 0; !reconnected && attempt < ReconnectAttempts && connection->isConnected(); attempt++) {
+            typename Protocol::ReconnectResponse response{};
+            auto start = std::chrono::steady_clock::now();
+            auto result =
+                co_await connection->request(Operation::ReconnectRequest, request, &response, this->configuration.responseTimeout);
+            if (result != RequestResult::Response) {
+                this->countFailure(result);
+                break;
+            } else if (response.responsecode() == Protocol::ReconnectSuccess) {
+                recordLatency(this->statistics.reconnectLatency, start);
+                this->statistics.responses.add();
+                this->sequenceCode = response.sequencecode();
+                reconnected = true;
+            } else if (response.responsecode() == Protocol::ReconnectInvalidState) {
+                co_await this->delay(std::chrono::milliseconds{100});
+            } else {
+                this->statistics.rejected.add();
+                break;
+            }
+        }
+        co_return reconnected;
+    }
+
+    boost::asio::awaitable<bool> ping(ConnectionPointer& connection) {
+        bool pinged{true};
+        typename Protocol::PingRequest request{};
+        for (size_t pingNr = 0; pinged && pingNr < this->configuration.pingsPerSession; pingNr++) {
+            co_await this->delay(this->configuration.pingInterval);
+            typename Protocol::PingResponse response{};
+            request.set_sequencecode(this->sequenceCode);
+            auto start = std::chrono::steady_clock::now();
+            auto result = co_await connection->request(Operation::PingRequest, request, &response, this->configuration.responseTimeout);
+            if (result != RequestResult::Response) {
+                this->countFailure(result);
+                pinged = false;
+            } else if (response.sequencecode() != this->sequenceCode) {
+                this->statistics.rejected.add();
+                pinged = false;
+            } else {
+                recordLatency(this->statistics.pingLatency, start);
+                this->statistics.responses.add();
+            }
+        }
+        co_return pinged;
+    }
+
+    boost::asio::awaitable<void> shutdown(ConnectionPointer& connection) {
+        typename Protocol::ShutdownRequest request{};
+        request.set_identifier(this->identifier);
+        co_await connection->request(Operation::ShutdownRequest, request, nullptr, this->configuration.responseTimeout);
+        // Shutdown has no response, socket is closed once request is written
+        while (connection->isSending()) {
+            co_await this->delay(std::chrono::milliseconds{1});
+        }
+        connection->disconnect();
+    }
+
+    boost::asio::awaitable<void> cycle() {
+        auto connection = co_await this->open();
+        if (connection && co_await this->connect(connection) && co_await this->ping(connection)) {
+            connection->disconnect();
+            connection = co_await this->open();
+            if (connection && co_await this->reconnect(connection) && co_await this->ping(connection)) {
+                co_await this->shutdown(connection);
+            }
+        }
+        if (connection) {
+            connection->disconnect();
+        }
+    }
+
+public:
+    LoadClient(Watchdog::IoContextPool::Shard& shard, const LoadConfiguration& configuration, LoadStatistics& statistics,
+               Types::Identifier identifier)
+        : shard{shard}, configuration{configuration}, statistics{statistics}, identifier{identifier}, delayTimer{shard.ioContext} {}
+    LoadClient(const LoadClient&) = delete;
+
+    // Start delay spreads connects of all clients according to connect rate
+    boost::asio::awaitable<void> run(std::chrono::milliseconds startDelay) {
+        co_await this->delay(startDelay);
+        this->statistics.activeClients.add();
+        for (size_t cycleNr = 0; cycleNr < this->configuration.cycles; cycleNr++) {
+            co_await this->cycle();
+        }
+        this->statistics.activeClients.sub();
+        this->statistics.finishedClients.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+} // namespace LoadGenerator
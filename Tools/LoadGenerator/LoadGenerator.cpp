@@ -0,0 +1,193 @@
+#include "LoadClient.hpp"
+#include "MongoDbEnvironment.hpp"
+#include "MongoModulesCollection.hpp"
+#include "MongoServicesCollection.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace LoadGenerator {
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: WatchdogLoadGenerator [options]\n"
+                 "  --host <address>           watchdog address (127.0.0.1)\n"
+                 "  --modules <count>          simulated modules, connect to port 1234 (100)\n"
+                 "  --services <count>         simulated services, connect to port 1235 (0)\n"
+                 "  --first-identifier <nr>    number of first identifier, next clients use following ones (1)\n"
+                 "  --ping-interval <ms>       delay between pings (1000)\n"
+                 "  --pings <count>            pings after connect and after reconnect (10)\n"
+                 "  --cycles <count>           Connect -> Ping -> Reconnect -> Ping -> Shutdown cycles per client (1)\n"
+                 "  --connect-rate <count>     clients started per second, 0 starts all at once (500)\n"
+                 "  --timeout <ms>             response timeout (8000)\n"
+                 "  --threads <count>          client threads (hardware concurrency)\n"
+                 "  --report-interval <s>      seconds between progress reports (5)\n"
+                 "  --seed                     insert clients records into mongodb first\n";
+}
+
+std::optional<LoadConfiguration> parseArguments(int argc, char** argv) {
+    LoadConfiguration configuration{};
+    using Setter = std::function<void(const std::string&)>;
+    const std::map<std::string, Setter> options{
+        {"--host", [&](const std::string& value) { configuration.host = value; }},
+        {"--modules", [&](const std::string& value) { configuration.modules = std::stoul(value); }},
+        {"--services", [&](const std::string& value) { configuration.services = std::stoul(value); }},
+        {"--first-identifier", [&](const std::string& value) { configuration.firstIdentifier = std::stoi(value); }},
+        {"--ping-interval", [&](const std::string& value) { configuration.pingInterval = std::chrono::milliseconds{std::stoul(value)}; }},
+        {"--pings", [&](const std::string& value) { configuration.pingsPerSession = std::stoul(value); }},
+        {"--cycles", [&](const std::string& value) { configuration.cycles = std::stoul(value); }},
+        {"--connect-rate", [&](const std::string& value) { configuration.connectRate = std::stoul(value); }},
+        {"--timeout", [&](const std::string& value) { configuration.responseTimeout = std::chrono::milliseconds{std::stoul(value)}; }},
+        {"--threads", [&](const std::string& value) { configuration.threads = std::max(1ul, std::stoul(value)); }},
+        {"--report-interval", [&](const std::string& value) { configuration.reportInterval = std::chrono::seconds{std::stoul(value)}; }},
+    };
+    bool parsed{true};
+    for (int argumentNr = 1; parsed && argumentNr < argc; argumentNr++) {
+        std::string argument{argv[argumentNr]};
+        if (argument == "--seed") {
+            configuration.seed = true;
+        } else if (auto option = options.find(argument); option == std::end(options) || argumentNr + 1 >= argc) {
+            std::cout << "Unknown option or missing value: " << argument << "\n";
+            parsed = false;
+        } else {
+            try {
+                option->second(argv[++argumentNr]);
+            } catch (std::exception& ex) {
+                std::cout << "Invalid value of " << argument << ": " << argv[argumentNr] << "\n";
+                parsed = false;
+            }
+        }
+    }
+    return parsed ? std::optional<LoadConfiguration>{configuration} : std::nullopt;
+}
+
+// Watchdog loads records missing in its registry from mongodb, so seeded records are usable without its restart
+bool seedRecords(const LoadConfiguration& configuration) {
+    bool seeded{false};
+    if (!Mongo::DbEnvironment::initialize() || !Mongo::DbEnvironment::getInstance() || !Mongo::DbEnvironment::isConnected()) {
+        std::cout << "Failed to connect to mongodb, records not seeded\n";
+    } else {
+        auto clientEntry = Mongo::DbEnvironment::getInstance()->getClient();
+        std::vector<ModuleRecord> modules{};
+        for (size_t moduleNr = 0; moduleNr < configuration.modules; moduleNr++) {
+            auto& record = modules.emplace_back();
+            record.identifier = ModuleProtocol::makeIdentifier(configuration.firstIdentifier + static_cast<Types::Identifier>(moduleNr));
+            record.connectionState = ModuleRecord::ConnectionState::Registered;
+        }
+        std::vector<ServiceRecord> services{};
+        for (size_t serviceNr = 0; serviceNr < configuration.services; serviceNr++) {
+            auto& record = services.emplace_back();
+            record.identifier = ServiceProtocol::makeIdentifier(configuration.firstIdentifier + static_cast<Types::Identifier>(serviceNr));
+            record.connectionState = ServiceRecord::ConnectionState::Registered;
+        }
+        Mongo::ModulesCollection modulesCollection{*clientEntry, "Modules"};
+        Mongo::ServicesCollection servicesCollection{*clientEntry, "Services"};
+        // Records left by previous runs are reported as failed inserts, they are still usable
+        bool modulesInserted = modulesCollection.insertMany(std::move(modules));
+        bool servicesInserted = servicesCollection.insertMany(std::move(services));
+        if (!modulesInserted) {
+            std::cout << "Some modules records were not inserted, they may already exist\n";
+        }
+        if (!servicesInserted) {
+            std::cout << "Some services records were not inserted, they may already exist\n";
+        }
+        seeded = true;
+    }
+    return seeded;
+}
+
+std::string formatLatency(const Metrics::Histogram& histogram) {
+    auto snapshot = histogram.snapshot();
+    std::ostringstream text{};
+    text << std::fixed << std::setprecision(3) << "p50 " << static_cast<double>(snapshot.quantile(0.5)) / 1e6 << " ms, p99 "
+         << static_cast<double>(snapshot.quantile(0.99)) / 1e6 << " ms, p999 " << static_cast<double>(snapshot.quantile(0.999)) / 1e6
+         << " ms (" << snapshot.count << " responses)";
+    return text.str();
+}
+
+void printReport(const LoadStatistics& statistics, std::chrono::seconds elapsed, double throughput) {
+    std::cout << "[" << std::setw(5) << elapsed.count() << "s] active " << statistics.activeClients.value() << ", finished "
+              << statistics.finishedClients.load(std::memory_order_relaxed) << ", responses " << statistics.responses.value() << " ("
+              << std::fixed << std::setprecision(1) << throughput << "/s), timeouts " << statistics.timeouts.value() << ", disconnects "
+              << statistics.disconnects.value() << ", rejected " << statistics.rejected.value() << "\n"
+              << "        ping " << formatLatency(statistics.pingLatency) << std::endl;
+}
+
+void printSummary(const LoadStatistics& statistics, std::chrono::seconds elapsed) {
+    auto responses = statistics.responses.value();
+    std::cout << "Summary after " << elapsed.count() << "s\n"
+              << "  responses   " << responses << " (" << std::fixed << std::setprecision(1)
+              << static_cast<double>(responses) / std::max<double>(1.0, static_cast<double>(elapsed.count())) << "/s)\n"
+              << "  timeouts    " << statistics.timeouts.value() << "\n"
+              << "  disconnects " << statistics.disconnects.value() << "\n"
+              << "  rejected    " << statistics.rejected.value() << "\n"
+              << "  connect     " << formatLatency(statistics.connectLatency) << "\n"
+              << "  ping        " << formatLatency(statistics.pingLatency) << "\n"
+              << "  reconnect   " << formatLatency(statistics.reconnectLatency) << std::endl;
+}
+
+template <typename Protocol>
+void startClients(Watchdog::IoContextPool& ioContextPool, const LoadConfiguration& configuration, LoadStatistics& statistics,
+                  std::vector<std::unique_ptr<LoadClient<Protocol>>>& clients, size_t clientsCount, size_t& clientNr) {
+    for (size_t protocolClientNr = 0; protocolClientNr < clientsCount; protocolClientNr++, clientNr++) {
+        auto& shard = ioContextPool.getShard(clientNr);
+        auto identifier = Protocol::makeIdentifier(configuration.firstIdentifier + static_cast<Types::Identifier>(protocolClientNr));
+        auto& client = clients.emplace_back(std::make_unique<LoadClient<Protocol>>(shard, configuration, statistics, identifier));
+        std::chrono::milliseconds startDelay{configuration.connectRate == 0 ? 0 : clientNr * 1000 / configuration.connectRate};
+        boost::asio::co_spawn(shard.ioContext, client->run(startDelay), boost::asio::detached);
+    }
+}
+
+} // namespace
+
+int run(const LoadConfiguration& configuration) {
+    if (configuration.seed && !seedRecords(configuration)) {
+        return 1;
+    }
+    LoadStatistics statistics{};
+    // Every thread runs its own io_context, client and all its connections stay on one of them
+    Watchdog::IoContextPool ioContextPool{configuration.threads, Watchdog::ConnectionsDispatch::RoundRobin};
+    std::vector<std::unique_ptr<LoadClient<ModuleProtocol>>> modules{};
+    std::vector<std::unique_ptr<LoadClient<ServiceProtocol>>> services{};
+    size_t clientNr{0};
+    startClients(ioContextPool, configuration, statistics, modules, configuration.modules, clientNr);
+    startClients(ioContextPool, configuration, statistics, services, configuration.services, clientNr);
+
+    std::vector<std::thread> threads{};
+    for (size_t threadNr = 0; threadNr < ioContextPool.size(); threadNr++) {
+        threads.emplace_back([&shard = ioContextPool.getShard(threadNr)]() { shard.ioContext.run(); });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto lastResponses = statistics.responses.value();
+    while (statistics.finishedClients.load(std::memory_order_relaxed) < clientNr) {
+        std::this_thread::sleep_for(configuration.reportInterval);
+        auto responses = statistics.responses.value();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start);
+        printReport(statistics, elapsed, static_cast<double>(responses - lastResponses) / configuration.reportInterval.count());
+        lastResponses = responses;
+    }
+    printSummary(statistics, std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start));
+
+    ioContextPool.stop();
+    std::for_each(std::begin(threads), std::end(threads), std::mem_fn(&std::thread::join));
+    return statistics.timeouts.value() + statistics.disconnects.value() == 0 ? 0 : 2;
+}
+
+} // namespace LoadGenerator
+
+int main(int argc, char** argv) {
+    auto configuration = LoadGenerator::parseArguments(argc, argv);
+    if (!configuration.has_value()) {
+        LoadGenerator::printUsage();
+        return 1;
+    }
+    return LoadGenerator::run(*configuration);
+}